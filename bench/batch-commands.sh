@@ -0,0 +1,49 @@
+#!/bin/sh
+
+# Compare the command rate of running one client per command against feeding
+# the same commands to a single batch mode (-B) client.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Lbench"
+$TMUX kill-server 2>/dev/null
+
+[ -z "$COUNT" ] && COUNT=500
+
+TMP=$(mktemp)
+trap "rm -f $TMP; $TMUX kill-server 2>/dev/null" 0 1 15
+
+now() {
+	date +%s%N
+}
+
+$TMUX -f/dev/null new -d || exit 1
+
+START=$(now)
+n=0
+while [ $n -lt $COUNT ]; do
+	$TMUX display -p '#{session_name}' >/dev/null || exit 1
+	n=$((n + 1))
+done
+END=$(now)
+SINGLE=$(((END - START) / 1000000))
+[ $SINGLE -eq 0 ] && SINGLE=1
+
+n=0
+while [ $n -lt $COUNT ]; do
+	echo "display -p '#{session_name}'"
+	n=$((n + 1))
+done >$TMP
+
+START=$(now)
+$TMUX -B <$TMP >/dev/null || exit 1
+END=$(now)
+BATCH=$(((END - START) / 1000000))
+[ $BATCH -eq 0 ] && BATCH=1
+
+echo "batch-commands: $COUNT commands"
+echo "  one client each: $SINGLE ms, $((COUNT * 1000 / SINGLE)) commands/sec"
+echo "  batch client:    $BATCH ms, $((COUNT * 1000 / BATCH)) commands/sec"
+exit 0
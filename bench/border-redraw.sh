@@ -0,0 +1,53 @@
+#!/bin/sh
+
+# Redraw a large client showing a window with many panes and report the server
+# CPU used.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Lbench"
+$TMUX kill-server 2>/dev/null
+TMUX2="$TEST_TMUX -Lbench2"
+$TMUX2 kill-server 2>/dev/null
+
+[ -z "$PANES" ] && PANES=30
+[ -z "$COUNT" ] && COUNT=200
+
+$TMUX2 -f/dev/null new -d -x300 -y80 'cat' || exit 1
+n=1
+while [ $n -lt $PANES ]; do
+	$TMUX2 splitw -d 'cat' || exit 1
+	$TMUX2 selectl tiled || exit 1
+	n=$((n + 1))
+done
+$TMUX -f/dev/null new -d -x300 -y80 "$TMUX2 attach" || exit 1
+sleep 1
+PID=$($TMUX2 display -p '#{pid}')
+CLIENT=$($TMUX2 lsc -F '#{client_name}')
+
+cpu() {
+	awk '{ print $14 + $15 }' /proc/$PID/stat
+}
+now() {
+	date +%s%N
+}
+
+START=$(now)
+CPU=$(cpu)
+n=0
+while [ $n -lt $COUNT ]; do
+	$TMUX2 refresh -t$CLIENT || exit 1
+	n=$((n + 1))
+done
+sleep 1
+END=$(now)
+CPU=$(($(cpu) - CPU))
+
+$TMUX kill-server 2>/dev/null
+$TMUX2 kill-server 2>/dev/null
+
+echo "border-redraw: $COUNT redraws of $PANES panes in" \
+    "$(((END - START) / 1000000)) ms, $CPU ticks server CPU"
+exit 0
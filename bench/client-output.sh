@@ -0,0 +1,58 @@
+#!/bin/sh
+
+# Attach several clients to a window producing a lot of output and report the
+# number of write system calls and CPU used by the server.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Lbench"
+$TMUX kill-server 2>/dev/null
+TMUX2="$TEST_TMUX -Lbench2"
+$TMUX2 kill-server 2>/dev/null
+
+[ -z "$CLIENTS" ] && CLIENTS=4
+[ -z "$COUNT" ] && COUNT=200000
+
+$TMUX2 -f/dev/null new -d -x80 -y24 || exit 1
+$TMUX -f/dev/null new -d -x80 -y24 "$TMUX2 attach" || exit 1
+n=1
+while [ $n -lt $CLIENTS ]; do
+	$TMUX neww -d "$TMUX2 attach" || exit 1
+	n=$((n + 1))
+done
+sleep 1
+PID=$($TMUX2 display -p '#{pid}')
+
+cpu() {
+	awk '{ print $14 + $15 }' /proc/$PID/stat
+}
+writes() {
+	awk '/^syscw/ { print $2 }' /proc/$PID/io
+}
+now() {
+	date +%s%N
+}
+
+START=$(now)
+CPU=$(cpu)
+WRITES=$(writes)
+$TMUX2 send -l "seq $COUNT; $TMUX2 set -g @done 1" || exit 1
+$TMUX2 send Enter || exit 1
+n=0
+while [ -z "$($TMUX2 show -gqv @done)" ]; do
+	n=$((n + 1))
+	[ $n -gt 1200 ] && exit 1
+	sleep 0.1
+done
+END=$(now)
+CPU=$(($(cpu) - CPU))
+WRITES=$(($(writes) - WRITES))
+
+$TMUX kill-server 2>/dev/null
+$TMUX2 kill-server 2>/dev/null
+
+echo "client-output: $CLIENTS clients, $COUNT lines in" \
+    "$(((END - START) / 1000000)) ms, $CPU ticks server CPU, $WRITES writes"
+exit 0
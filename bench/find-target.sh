@@ -0,0 +1,48 @@
+#!/bin/sh
+
+# Resolve window targets by name, prefix and pattern in a session with many
+# windows and report the time taken.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Lbench"
+$TMUX kill-server 2>/dev/null
+
+[ -z "$WINDOWS" ] && WINDOWS=1000
+[ -z "$COUNT" ] && COUNT=20000
+
+TMP=$(mktemp)
+trap "rm -f $TMP" 0 1 15
+
+now() {
+	date +%s%N
+}
+
+$TMUX -f/dev/null new -d -s bench 'cat' || exit 1
+awk -vn=$WINDOWS 'BEGIN {
+	for (i = 1; i < n; i++)
+		printf "neww -d -n window%05d cat\n", i
+}' >$TMP
+$TMUX source $TMP || exit 1
+awk -vn=$WINDOWS -vc=$COUNT 'BEGIN {
+	for (i = 0; i < c; i++) {
+		w = 1 + (i * 7) % (n - 1)
+		if (i % 3 == 0)
+			printf "display -pt bench:window%05d \"\"\n", w
+		else if (i % 3 == 1)
+			printf "display -pt bench:window%04d \"\"\n", w / 10
+		else
+			printf "display -pt \"bench:w*%05d\" \"\"\n", w
+	}
+}' >$TMP
+
+START=$(now)
+$TMUX source -q $TMP >/dev/null 2>&1
+END=$(now)
+$TMUX kill-server 2>/dev/null
+
+echo "find-target: $COUNT targets with $WINDOWS windows in" \
+    "$(((END - START) / 1000000)) ms"
+exit 0
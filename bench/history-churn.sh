@@ -0,0 +1,56 @@
+#!/bin/sh
+
+# Scroll lines with RGB colours and wide characters through a pane so the
+# history is repeatedly filled and collected, and report the time, server CPU
+# and server memory used.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Lbench"
+$TMUX kill-server 2>/dev/null
+
+[ -z "$COUNT" ] && COUNT=200000
+[ -z "$LINES" ] && LINES=20000
+
+TMP=$(mktemp)
+trap "rm -f $TMP" 0 1 15
+
+awk -vcount=$COUNT 'BEGIN {
+	for (i = 0; i < count; i++) {
+		for (x = 0; x < 20; x++) {
+			if (x % 4 == 0)
+				printf "\344\275\240"
+			else {
+				printf "\033[38;2;%d;%d;%dm%c", \
+				    (i + x) % 256, x * 12, i % 256, 65 + x
+			}
+		}
+		printf "\033[m %d\n", i
+	}
+}' >$TMP
+
+$TMUX -f/dev/null new -d -x80 -y24 \; set -g history-limit $LINES || exit 1
+PID=$($TMUX display -p '#{pid}')
+
+cpu() {
+	awk '{ print $14 + $15 }' /proc/$PID/stat
+}
+now() {
+	date +%s%N
+}
+
+START=$(now)
+CPU=$(cpu)
+$TMUX neww "cat $TMP; $TMUX wait -S done; cat" || exit 1
+$TMUX wait done || exit 1
+END=$(now)
+CPU=$(($(cpu) - CPU))
+RSS=$(awk '/^VmRSS/ { print $2 }' /proc/$PID/status)
+
+$TMUX kill-server 2>/dev/null
+
+echo "history-churn: $COUNT lines in $(((END - START) / 1000000)) ms," \
+    "$CPU ticks server CPU, $RSS kB server RSS"
+exit 0
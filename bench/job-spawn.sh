@@ -0,0 +1,52 @@
+#!/bin/sh
+
+# Fill a pane's history until the server holds a lot of memory, then run many
+# short jobs and report the time and server CPU used to start them.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Lbench"
+$TMUX kill-server 2>/dev/null
+
+[ -z "$SIZE" ] && SIZE=2048
+[ -z "$COUNT" ] && COUNT=200
+
+# Each 1000-column line of history takes about 4 KB.
+LINES=$((SIZE * 256))
+
+$TMUX -f/dev/null new -d -x1000 -y50 \; set -g history-limit $LINES \; \
+	neww "awk 'BEGIN {
+		s = sprintf(\"%1000s\", \"\"); gsub(/ /, \"x\", s)
+		for (i = 0; i < $LINES; i++) print s
+	}'; $TMUX wait -S done; cat" || exit 1
+$TMUX wait done || exit 1
+PID=$($TMUX display -p '#{pid}')
+RSS=$(awk '/^VmRSS/ { print int($2 / 1024) }' /proc/$PID/status)
+
+cpu() {
+	awk '{ print $14 + $15 }' /proc/$PID/stat
+}
+now() {
+	date +%s%N
+}
+
+CMD=
+n=0
+while [ $n -lt $COUNT ]; do
+	CMD="$CMD run true ;"
+	n=$((n + 1))
+done
+
+START=$(now)
+CPU=$(cpu)
+$TMUX $CMD || exit 1
+END=$(now)
+CPU=$(($(cpu) - CPU))
+
+$TMUX kill-server 2>/dev/null
+
+echo "job-spawn: $COUNT jobs with $RSS MB server RSS in" \
+    "$(((END - START) / 1000000)) ms, $CPU ticks server CPU"
+exit 0
@@ -0,0 +1,63 @@
+#!/bin/sh
+
+# Feed a large buffer of text and key sequences into an attached client and
+# report how long the server takes to decode it with tty_keys_next.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Lbench"
+$TMUX kill-server 2>/dev/null
+TMUX2="$TEST_TMUX -Lbench2"
+$TMUX2 kill-server 2>/dev/null
+
+[ -z "$COUNT" ] && COUNT=50000
+
+TMP=$(mktemp)
+trap "rm -f $TMP" 0 1 15
+
+awk -vn=$COUNT 'BEGIN {
+	for (i = 0; i < n; i++) {
+		printf "some text to type %d ", i
+		printf "\033[A\033[B\033OC\033[1;5D\033[15;2~\033[3~"
+	}
+	printf "\033[1;5A\033[24~"
+}' >$TMP
+SIZE=$(wc -c <$TMP)
+
+$TMUX2 -f/dev/null new -d 'stty raw -echo; cat >/dev/null' || exit 1
+$TMUX2 set -g assume-paste-time 0 || exit 1
+$TMUX2 bind -n C-Up set -g @up 1 || exit 1
+$TMUX2 bind -n F12 set -g @done 1 || exit 1
+$TMUX -f/dev/null new -d "$TMUX2 attach" || exit 1
+sleep 1
+PID=$($TMUX2 display -p '#{pid}')
+
+cpu() {
+	awk '{ print $14 + $15 }' /proc/$PID/stat
+}
+now() {
+	date +%s%N
+}
+
+START=$(now)
+CPU=$(cpu)
+$TMUX loadb $TMP || exit 1
+$TMUX pasteb || exit 1
+n=0
+while [ -z "$($TMUX2 show -gqv @done)" ]; do
+	n=$((n + 1))
+	[ $n -gt 1200 ] && exit 1
+	sleep 0.1
+done
+END=$(now)
+CPU=$(($(cpu) - CPU))
+[ "$($TMUX2 show -gqv @up)" = 1 ] || exit 1
+
+$TMUX kill-server 2>/dev/null
+$TMUX2 kill-server 2>/dev/null
+
+echo "keys-input: $SIZE bytes in $(((END - START) / 1000000)) ms," \
+    "$CPU ticks server CPU"
+exit 0
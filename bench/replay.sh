@@ -0,0 +1,106 @@
+#!/bin/sh
+
+# Replay recorded output through a pane with several clients attached and
+# report the parse rate, the bytes written to each client and the server CPU
+# and peak memory. Recordings may be given as arguments; otherwise
+# tools/UTF-8-demo.txt, a generated full screen application and a generated
+# log are used.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Lbench"
+$TMUX kill-server 2>/dev/null
+TMUX2="$TEST_TMUX -Lbench2"
+$TMUX2 kill-server 2>/dev/null
+
+[ -z "$CLIENTS" ] && CLIENTS=2
+[ -z "$REPEAT" ] && REPEAT=50
+
+TMP=$(mktemp -d)
+trap "rm -rf $TMP" 0 1 15
+
+if [ $# -eq 0 ]; then
+	cp ../tools/UTF-8-demo.txt $TMP/utf8-demo || exit 1
+
+	# A full screen application redrawing parts of the screen in colour.
+	awk 'BEGIN {
+		x = 1
+		for (f = 0; f < 20; f++) {
+			printf "\033[H\033[2J\033[1;24r"
+			for (i = 0; i < 200; i++) {
+				x = (x * 75 + 74) % 65537
+				printf "\033[%d;%dH\033[%d;%dm%-*s\033[m", \
+				    x % 24 + 1, x % 40 + 1, 30 + x % 8, \
+				    40 + (x / 8) % 8, x % 30 + 5, "cpu " x
+				if (i % 20 == 0)
+					printf "\033[5;20r\033[20H\n\n\n\033[r"
+			}
+		}
+	}' >$TMP/fullscreen || exit 1
+
+	# A log of plain lines.
+	awk 'BEGIN {
+		for (i = 0; i < 2000; i++)
+			printf "%06d info request %d served in %d ms\n", i, i * 7, i % 97
+	}' >$TMP/log || exit 1
+
+	set -- $TMP/utf8-demo $TMP/fullscreen $TMP/log
+fi
+
+$TMUX2 -f/dev/null new -d -x80 -y24 || exit 1
+$TMUX2 set -g status off || exit 1
+$TMUX -f/dev/null new -d -x80 -y24 "$TMUX2 attach" || exit 1
+n=1
+while [ $n -lt $CLIENTS ]; do
+	$TMUX neww -d "$TMUX2 attach" || exit 1
+	n=$((n + 1))
+done
+sleep 1
+PID=$($TMUX2 display -p '#{pid}')
+
+cpu() {
+	awk '{ print $14 + $15 }' /proc/$PID/stat
+}
+written() {
+	$TMUX2 lsc -F '#{client_written}' | awk '{ n += $1 } END { print n }'
+}
+peak() {
+	awk '/^VmHWM/ { print $2 }' /proc/$PID/status
+}
+now() {
+	date +%s%N
+}
+
+for i in "$@"; do
+	n=0
+	while [ $n -lt $REPEAT ]; do
+		cat $i
+		n=$((n + 1))
+	done >$TMP/replay
+	SIZE=$(wc -c <$TMP/replay)
+
+	CMD="$TMUX2 wait go; cat $TMP/replay; $TMUX2 wait -S done; cat"
+	$TMUX2 respawnp -k "$CMD" || exit 1
+	sleep 1
+	START=$(now)
+	CPU=$(cpu)
+	WRITTEN=$(written)
+	$TMUX2 wait -S go || exit 1
+	$TMUX2 wait done || exit 1
+	END=$(now)
+	CPU=$(($(cpu) - CPU))
+	WRITTEN=$((($(written) - WRITTEN) / CLIENTS))
+
+	awk -v name=$(basename $i) -v size=$SIZE -v t=$(((END - START) / 1000)) \
+	    -v cpu=$CPU -v written=$WRITTEN -v peak=$(peak) 'BEGIN {
+		printf "replay: %s, %d bytes in %d ms, %.1f MB/s, " \
+		    "%d bytes per client, %d ticks server CPU, %d KB peak\n",
+		    name, size, t / 1000, size / t, written, cpu, peak
+	}'
+done
+
+$TMUX kill-server 2>/dev/null
+$TMUX2 kill-server 2>/dev/null
+exit 0
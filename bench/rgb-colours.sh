@@ -0,0 +1,66 @@
+#!/bin/sh
+
+# Redraw a large client without RGB support showing a screen full of RGB
+# colours and report the server CPU used.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Lbench"
+$TMUX kill-server 2>/dev/null
+TMUX2="$TEST_TMUX -Lbench2"
+$TMUX2 kill-server 2>/dev/null
+
+[ -z "$COUNT" ] && COUNT=200
+[ -z "$APPROXIMATION" ] && APPROXIMATION=nearest
+
+TMP=$(mktemp)
+trap "rm -f $TMP" 0 1 15
+
+awk 'BEGIN {
+	for (y = 0; y < 80; y++) {
+		for (x = 0; x < 300; x++) {
+			printf "\033[38;2;%d;%d;%dm\033[48;2;%d;%d;%dm%c", \
+			    x % 256, (y * 3) % 256, (x + y) % 256, \
+			    255 - x % 256, (x * y) % 256, (y * 3) % 256, \
+			    65 + x % 26
+		}
+	}
+	printf "\033[m"
+}' >$TMP
+
+$TMUX2 -f/dev/null new -d -x300 -y80 "cat $TMP; cat" || exit 1
+$TMUX2 set -g status off || exit 1
+$TMUX2 set -g colour-approximation $APPROXIMATION 2>/dev/null
+$TMUX -f/dev/null new -d -x300 -y80 || exit 1
+$TMUX set -g default-terminal screen-256color || exit 1
+$TMUX respawnw -k "$TMUX2 attach" || exit 1
+sleep 1
+PID=$($TMUX2 display -p '#{pid}')
+CLIENT=$($TMUX2 lsc -F '#{client_name}')
+
+cpu() {
+	awk '{ print $14 + $15 }' /proc/$PID/stat
+}
+now() {
+	date +%s%N
+}
+
+START=$(now)
+CPU=$(cpu)
+n=0
+while [ $n -lt $COUNT ]; do
+	$TMUX2 refresh -t$CLIENT || exit 1
+	n=$((n + 1))
+done
+sleep 1
+END=$(now)
+CPU=$(($(cpu) - CPU))
+
+$TMUX kill-server 2>/dev/null
+$TMUX2 kill-server 2>/dev/null
+
+echo "rgb-colours: $COUNT redraws ($APPROXIMATION) in" \
+    "$(((END - START) / 1000000)) ms, $CPU ticks server CPU"
+exit 0
@@ -0,0 +1,35 @@
+#!/bin/sh
+
+# Start and kill a server repeatedly and report the average time for new -d to
+# return with the session ready.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Lbench"
+$TMUX kill-server 2>/dev/null
+
+[ -z "$COUNT" ] && COUNT=50
+
+now() {
+	date +%s%N
+}
+
+TOTAL=0
+n=0
+while [ $n -lt $COUNT ]; do
+	START=$(now)
+	$TMUX -f/dev/null new -d || exit 1
+	END=$(now)
+	TOTAL=$((TOTAL + END - START))
+	$TMUX kill-server 2>/dev/null
+	while $TMUX has 2>/dev/null; do
+		sleep 0.01
+	done
+	sleep 0.05
+	n=$((n + 1))
+done
+
+echo "startup: $COUNT servers, $((TOTAL / COUNT / 1000)) us average"
+exit 0
@@ -0,0 +1,62 @@
+#!/bin/sh
+
+# Move several megabytes through load-buffer -, save-buffer - and
+# capture-pane -p, through a pipe and to a file, and report the time and
+# server CPU used for each.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Lbench"
+$TMUX kill-server 2>/dev/null
+
+[ -z "$SIZE" ] && SIZE=32
+[ -z "$LINES" ] && LINES=100000
+
+IN=$(mktemp)
+OUT=$(mktemp)
+trap "rm -f $IN $OUT" 0 1 15
+
+awk -vsize=$SIZE 'BEGIN {
+	for (i = 0; i < size * 16384; i++)
+		printf "%063d\n", i
+}' >$IN
+
+$TMUX -f/dev/null new -d -x80 -y24 \; set -g history-limit $LINES \; \
+	neww "head -$LINES $IN; $TMUX wait -S done; cat" || exit 1
+$TMUX wait done || exit 1
+PID=$($TMUX display -p '#{pid}')
+
+cpu() {
+	awk '{ print $14 + $15 }' /proc/$PID/stat
+}
+now() {
+	date +%s%N
+}
+
+# Run a command and report how long it took.
+run() {
+	name=$1
+	shift
+
+	START=$(now)
+	CPU=$(cpu)
+	"$@" || exit 1
+	END=$(now)
+	CPU=$(($(cpu) - CPU))
+	echo "transfer: $name in $(((END - START) / 1000000)) ms," \
+	    "$CPU ticks server CPU"
+}
+
+run "load-buffer $SIZE MB from file" sh -c "$TMUX loadb - <$IN"
+run "load-buffer $SIZE MB from pipe" sh -c "cat $IN | $TMUX loadb -"
+run "save-buffer $SIZE MB to file" sh -c "$TMUX saveb - >$OUT"
+cmp -s $IN $OUT || exit 1
+run "save-buffer $SIZE MB to pipe" sh -c "$TMUX saveb - | cat >$OUT"
+cmp -s $IN $OUT || exit 1
+run "capture-pane $LINES lines to pipe" \
+	sh -c "$TMUX capturep -p -S- -t:1 | cat >$OUT"
+
+$TMUX kill-server 2>/dev/null
+exit 0
@@ -0,0 +1,61 @@
+#!/bin/sh
+
+# Draw coloured cells at scattered positions in a pane shown on an attached
+# client, so most output to the client is cursor movement and colour changes,
+# and report the server CPU used.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Lbench"
+$TMUX kill-server 2>/dev/null
+TMUX2="$TEST_TMUX -Lbench2"
+$TMUX2 kill-server 2>/dev/null
+
+[ -z "$COUNT" ] && COUNT=200000
+
+TMP=$(mktemp)
+trap "rm -f $TMP" 0 1 15
+
+awk -vn=$COUNT 'BEGIN {
+	srand(1)
+	for (i = 0; i < n; i++) {
+		printf "\033[%d;%dH\033[3%d;4%dmx", int(rand() * 24) + 1,
+		    int(rand() * 80) + 1, i % 8, (i / 8) % 8
+	}
+}' >$TMP
+SIZE=$(wc -c <$TMP)
+
+$TMUX2 -f/dev/null new -d -x80 -y24 || exit 1
+$TMUX2 set -g status off || exit 1
+$TMUX -f/dev/null new -d -x80 -y24 "$TMUX2 attach" || exit 1
+sleep 1
+PID=$($TMUX2 display -p '#{pid}')
+
+cpu() {
+	awk '{ print $14 + $15 }' /proc/$PID/stat
+}
+now() {
+	date +%s%N
+}
+
+START=$(now)
+CPU=$(cpu)
+$TMUX2 send -l "clear; cat $TMP; $TMUX2 set -g @done 1" || exit 1
+$TMUX2 send Enter || exit 1
+n=0
+while [ -z "$($TMUX2 show -gqv @done)" ]; do
+	n=$((n + 1))
+	[ $n -gt 1200 ] && exit 1
+	sleep 0.1
+done
+END=$(now)
+CPU=$(($(cpu) - CPU))
+
+$TMUX kill-server 2>/dev/null
+$TMUX2 kill-server 2>/dev/null
+
+echo "tty-escapes: $SIZE bytes in $(((END - START) / 1000000)) ms," \
+    "$CPU ticks server CPU"
+exit 0
@@ -388,6 +388,7 @@ client_main(struct event_base *base, int argc, char **argv, int flags)
 	} else if (client_exitreason != CLIENT_EXIT_NONE)
 		fprintf(stderr, "%s\n", client_exit_message());
 	setblocking(STDIN_FILENO, 1);
+	setblocking(STDOUT_FILENO, 1);
 	return (client_exitval);
 }
 
@@ -415,6 +416,16 @@ client_send_identify(const char *ttynam, const char *cwd)
 		fatal("dup failed");
 	proc_send(client_peer, MSG_IDENTIFY_STDIN, fd, NULL, 0);
 
+	/*
+	 * If stdout is not a terminal, pass it to the server too so it can
+	 * write output there directly.
+	 */
+	if (~flags & CLIENT_CONTROL && !isatty(STDOUT_FILENO)) {
+		if ((fd = dup(STDOUT_FILENO)) == -1)
+			fatal("dup failed");
+		proc_send(client_peer, MSG_IDENTIFY_STDOUT, fd, NULL, 0);
+	}
+
 	pid = getpid();
 	proc_send(client_peer, MSG_IDENTIFY_CLIENTPID, -1, &pid, sizeof pid);
 
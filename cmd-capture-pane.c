@@ -32,8 +32,14 @@ static enum cmd_retval	cmd_capture_pane_exec(struct cmd *, struct cmdq_item *);
 static char	*cmd_capture_pane_append(char *, size_t *, char *, size_t);
 static char	*cmd_capture_pane_pending(struct args *, struct window_pane *,
 		     size_t *);
+static struct grid *cmd_capture_pane_grid(struct args *, struct cmdq_item *,
+		     struct window_pane *);
+static void	 cmd_capture_pane_range(struct args *, struct grid *, u_int *,
+		     u_int *);
 static char	*cmd_capture_pane_history(struct args *, struct cmdq_item *,
 		     struct window_pane *, size_t *);
+static enum cmd_retval cmd_capture_pane_stream(struct args *,
+		     struct cmdq_item *, struct window_pane *);
 
 const struct cmd_entry cmd_capture_pane_entry = {
 	.name = "capture-pane",
@@ -62,6 +68,32 @@ const struct cmd_entry cmd_clear_history_entry = {
 	.exec = cmd_capture_pane_exec
 };
 
+/*
+ * Capturing history to stdout is done a few lines at a time, carrying on each
+ * time the client's stdout has been written, so a large capture does not block
+ * the server or need the whole history in memory at once. The pane keeps
+ * being read while it is in progress; lines removed from the top of the
+ * history are followed using the grid's count of trimmed lines.
+ */
+#define CAPTURE_PANE_CHUNK 65536
+
+struct cmd_capture_pane_data {
+	struct cmdq_item	*item;
+	struct client		*client;
+
+	u_int			 pane;
+	int			 alternate;
+	u_int			 trimmed;
+	u_int			 line;
+	u_int			 bottom;
+
+	int			 with_codes;
+	int			 escape_c0;
+	int			 join_lines;
+	int			 no_trim;
+	struct grid_cell	 lastgc;
+};
+
 static char *
 cmd_capture_pane_append(char *buf, size_t *len, char *line, size_t linelen)
 {
@@ -103,31 +135,25 @@ cmd_capture_pane_pending(struct args *args, struct window_pane *wp,
 	return (buf);
 }
 
-static char *
-cmd_capture_pane_history(struct args *args, struct cmdq_item *item,
-    struct window_pane *wp, size_t *len)
+static struct grid *
+cmd_capture_pane_grid(struct args *args, struct cmdq_item *item,
+    struct window_pane *wp)
 {
-	struct grid		*gd;
-	const struct grid_line	*gl;
-	struct grid_cell	*gc = NULL;
-	int			 n, with_codes, escape_c0, join_lines, no_trim;
-	u_int			 i, sx, top, bottom, tmp;
-	char			*cause, *buf, *line;
-	const char		*Sflag, *Eflag;
-	size_t			 linelen;
+	if (!args_has(args, 'a'))
+		return (wp->base.grid);
+	if (wp->saved_grid == NULL && !args_has(args, 'q'))
+		cmdq_error(item, "no alternate screen");
+	return (wp->saved_grid);
+}
 
-	sx = screen_size_x(&wp->base);
-	if (args_has(args, 'a')) {
-		gd = wp->saved_grid;
-		if (gd == NULL) {
-			if (!args_has(args, 'q')) {
-				cmdq_error(item, "no alternate screen");
-				return (NULL);
-			}
-			return (xstrdup(""));
-		}
-	} else
-		gd = wp->base.grid;
+static void
+cmd_capture_pane_range(struct args *args, struct grid *gd, u_int *topp,
+    u_int *bottomp)
+{
+	int		 n;
+	u_int		 top, bottom, tmp;
+	char		*cause;
+	const char	*Sflag, *Eflag;
 
 	Sflag = args_get(args, 'S');
 	if (Sflag != NULL && strcmp(Sflag, "-") == 0)
@@ -166,6 +192,30 @@ cmd_capture_pane_history(struct args *args, struct cmdq_item *item,
 		bottom = top;
 		top = tmp;
 	}
+	*topp = top;
+	*bottomp = bottom;
+}
+
+static char *
+cmd_capture_pane_history(struct args *args, struct cmdq_item *item,
+    struct window_pane *wp, size_t *len)
+{
+	struct grid		*gd;
+	const struct grid_line	*gl;
+	struct grid_cell	*gc = NULL;
+	int			 with_codes, escape_c0, join_lines, no_trim;
+	u_int			 i, sx, top, bottom;
+	char			*buf, *line;
+	size_t			 linelen;
+
+	sx = screen_size_x(&wp->base);
+	gd = cmd_capture_pane_grid(args, item, wp);
+	if (gd == NULL) {
+		if (!args_has(args, 'q'))
+			return (NULL);
+		return (xstrdup(""));
+	}
+	cmd_capture_pane_range(args, gd, &top, &bottom);
 
 	with_codes = args_has(args, 'e');
 	escape_c0 = args_has(args, 'C');
@@ -189,6 +239,131 @@ cmd_capture_pane_history(struct args *args, struct cmdq_item *item,
 	return (buf);
 }
 
+/* Write the next lines to the client. Returns 1 when finished. */
+static int
+cmd_capture_pane_stream_write(struct cmd_capture_pane_data *cdata)
+{
+	struct client		*c = cdata->client;
+	struct window_pane	*wp;
+	struct grid		*gd;
+	const struct grid_line	*gl;
+	struct grid_cell	*gc = &cdata->lastgc;
+	u_int			 sx, last, n;
+	char			*line;
+
+	/*
+	 * The pane may have gone or been resized while waiting, so look it up
+	 * again and stop at the end of the grid.
+	 */
+	wp = window_pane_find_by_id(cdata->pane);
+	if (wp == NULL)
+		return (1);
+	if (cdata->alternate)
+		gd = wp->saved_grid;
+	else
+		gd = wp->base.grid;
+	if (gd == NULL)
+		return (1);
+
+	/*
+	 * Move up by any lines removed from the top of the history. Lines that
+	 * have gone before they could be written are skipped.
+	 */
+	n = gd->htrimmed - cdata->trimmed;
+	cdata->trimmed = gd->htrimmed;
+	if (n > cdata->bottom)
+		return (1);
+	cdata->bottom -= n;
+	if (n > cdata->line)
+		cdata->line = 0;
+	else
+		cdata->line -= n;
+
+	last = gd->hsize + gd->sy - 1;
+	if (cdata->bottom > last)
+		cdata->bottom = last;
+	sx = screen_size_x(&wp->base);
+
+	while (cdata->line <= cdata->bottom &&
+	    EVBUFFER_LENGTH(c->stdout_data) < CAPTURE_PANE_CHUNK) {
+		line = grid_string_cells(gd, 0, cdata->line, sx, &gc,
+		    cdata->with_codes, cdata->escape_c0,
+		    !cdata->join_lines && !cdata->no_trim);
+		evbuffer_add(c->stdout_data, line, strlen(line));
+		free(line);
+
+		gl = grid_peek_line(gd, cdata->line);
+		if (!cdata->join_lines || !(gl->flags & GRID_LINE_WRAPPED))
+			evbuffer_add(c->stdout_data, "\n", 1);
+		cdata->line++;
+	}
+	server_client_push_stdout(c);
+
+	return (cdata->line > cdata->bottom);
+}
+
+static void
+cmd_capture_pane_stream_callback(struct client *c, int closed, void *data)
+{
+	struct cmd_capture_pane_data	*cdata = data;
+	struct window_pane		*wp;
+
+	if (!closed && !cmd_capture_pane_stream_write(cdata))
+		return;
+
+	wp = window_pane_find_by_id(cdata->pane);
+	if (wp != NULL && --wp->capturing == 0)
+		window_collect_history_reset();
+
+	c->stdout_callback = NULL;
+	c->stdout_callback_data = NULL;
+
+	cmdq_continue(cdata->item);
+	free(cdata);
+}
+
+static enum cmd_retval
+cmd_capture_pane_stream(struct args *args, struct cmdq_item *item,
+    struct window_pane *wp)
+{
+	struct cmd_capture_pane_data	*cdata;
+	struct client			*c = item->client;
+	struct grid			*gd;
+
+	gd = cmd_capture_pane_grid(args, item, wp);
+	if (gd == NULL) {
+		if (!args_has(args, 'q'))
+			return (CMD_RETURN_ERROR);
+		return (CMD_RETURN_NORMAL);
+	}
+
+	cdata = xcalloc(1, sizeof *cdata);
+	cdata->item = item;
+	cdata->client = c;
+
+	cdata->pane = wp->id;
+	cdata->alternate = args_has(args, 'a');
+	cdata->trimmed = gd->htrimmed;
+	cmd_capture_pane_range(args, gd, &cdata->line, &cdata->bottom);
+
+	cdata->with_codes = args_has(args, 'e');
+	cdata->escape_c0 = args_has(args, 'C');
+	cdata->join_lines = args_has(args, 'J');
+	cdata->no_trim = args_has(args, 'N');
+	memcpy(&cdata->lastgc, &grid_default_cell, sizeof cdata->lastgc);
+
+	c->stdout_callback = cmd_capture_pane_stream_callback;
+	c->stdout_callback_data = cdata;
+	if (cmd_capture_pane_stream_write(cdata)) {
+		c->stdout_callback = NULL;
+		c->stdout_callback_data = NULL;
+		free(cdata);
+		return (CMD_RETURN_NORMAL);
+	}
+	wp->capturing++;
+	return (CMD_RETURN_WAIT);
+}
+
 static enum cmd_retval
 cmd_capture_pane_exec(struct cmd *self, struct cmdq_item *item)
 {
@@ -205,6 +380,18 @@ cmd_capture_pane_exec(struct cmd *self, struct cmdq_item *item)
 		return (CMD_RETURN_NORMAL);
 	}
 
+	/*
+	 * History is written to stdout a little at a time, except for control
+	 * clients where other output must not be mixed in with it.
+	 */
+	c = item->client;
+	if (args_has(args, 'p') &&
+	    !args_has(args, 'P') &&
+	    c != NULL &&
+	    c->session == NULL &&
+	    (~c->flags & CLIENT_CONTROL))
+		return (cmd_capture_pane_stream(args, item, wp));
+
 	len = 0;
 	if (args_has(args, 'P'))
 		buf = cmd_capture_pane_pending(args, wp, &len);
@@ -214,7 +401,6 @@ cmd_capture_pane_exec(struct cmd *self, struct cmdq_item *item)
 		return (CMD_RETURN_ERROR);
 
 	if (args_has(args, 'p')) {
-		c = item->client;
 		if (c == NULL ||
 		    (c->session != NULL && !(c->flags & CLIENT_CONTROL))) {
 			cmdq_error(item, "can't write to stdout");
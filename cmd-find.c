@@ -34,6 +34,9 @@ static int	cmd_find_best_winlink_with_window(struct cmd_find_state *);
 
 static const char *cmd_find_map_table(const char *[][2], const char *);
 
+static u_int	cmd_find_name_lower(struct winlink **, u_int, const char *,
+		    size_t);
+
 static void	cmd_find_log_state(const char *, struct cmd_find_state *);
 static int	cmd_find_get_session(struct cmd_find_state *, const char *);
 static int	cmd_find_get_window(struct cmd_find_state *, const char *, int);
@@ -162,7 +165,9 @@ cmd_find_best_session(struct session **slist, u_int ssize, int flags)
 			if (cmd_find_session_better(slist[i], s, flags))
 				s = slist[i];
 		}
-	} else {
+	} else if (~flags & CMD_FIND_PREFER_UNATTACHED)
+		s = session_find_latest();
+	else {
 		RB_FOREACH(s_loop, sessions, &sessions) {
 			if (cmd_find_session_better(s_loop, s, flags))
 				s = s_loop;
@@ -243,12 +248,33 @@ cmd_find_map_table(const char *table[][2], const char *s)
 	return (s);
 }
 
+/*
+ * Find the first winlink in a name index whose window name is not less than
+ * the first len bytes of name.
+ */
+static u_int
+cmd_find_name_lower(struct winlink **list, u_int size, const char *name,
+    size_t len)
+{
+	u_int	lo = 0, hi = size, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (strncmp(list[mid]->window->name, name, len) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return (lo);
+}
+
 /* Find session from string. Fills in s. */
 static int
 cmd_find_get_session(struct cmd_find_state *fs, const char *session)
 {
-	struct session	*s, *s_loop;
+	struct session	*s, *s_loop, find;
 	struct client	*c;
+	size_t		 len;
 
 	log_debug("%s: %s", __func__, session);
 
@@ -276,23 +302,34 @@ cmd_find_get_session(struct cmd_find_state *fs, const char *session)
 	if (fs->flags & CMD_FIND_EXACT_SESSION)
 		return (-1);
 
-	/* Otherwise look for prefix. */
-	s = NULL;
-	RB_FOREACH(s_loop, sessions, &sessions) {
-		if (strncmp(session, s_loop->name, strlen(session)) == 0) {
-			if (s != NULL)
-				return (-1);
-			s = s_loop;
-		}
-	}
-	if (s != NULL) {
+	/*
+	 * Otherwise look for prefix. Sessions are sorted by name, so the only
+	 * candidates are the first session not less than the prefix and the
+	 * one after it.
+	 */
+	len = strlen(session);
+	find.name = (char *)session;
+	s = RB_NFIND(sessions, &sessions, &find);
+	if (s != NULL && strncmp(session, s->name, len) == 0) {
+		s_loop = RB_NEXT(sessions, &sessions, s);
+		if (s_loop != NULL && strncmp(session, s_loop->name, len) == 0)
+			return (-1);
 		fs->s = s;
 		return (0);
 	}
 
-	/* Then as a pattern. */
+	/*
+	 * Then as a pattern, starting at the part of the pattern before any
+	 * special characters.
+	 */
+	len = strcspn(session, "*?[\\");
+	find.name = xstrndup(session, len);
+	s_loop = RB_NFIND(sessions, &sessions, &find);
+	free(find.name);
 	s = NULL;
-	RB_FOREACH(s_loop, sessions, &sessions) {
+	for (; s_loop != NULL; s_loop = RB_NEXT(sessions, &sessions, s_loop)) {
+		if (strncmp(session, s_loop->name, len) != 0)
+			break;
 		if (fnmatch(session, s_loop->name, 0) == 0) {
 			if (s != NULL)
 				return (-1);
@@ -347,10 +384,12 @@ cmd_find_get_window(struct cmd_find_state *fs, const char *window, int only)
 static int
 cmd_find_get_window_with_session(struct cmd_find_state *fs, const char *window)
 {
-	struct winlink	*wl;
+	struct winlink	*wl, **list;
 	const char	*errstr;
 	int		 idx, n, exact;
 	struct session	*s;
+	u_int		 i, size;
+	size_t		 len;
 
 	log_debug("%s: %s", __func__, window);
 	exact = (fs->flags & CMD_FIND_EXACT_WINDOW);
@@ -443,16 +482,21 @@ cmd_find_get_window_with_session(struct cmd_find_state *fs, const char *window)
 		}
 	}
 
+	/*
+	 * The remaining lookups use the session's index of winlinks sorted by
+	 * window name, so matches are next to each other.
+	 */
+	list = session_name_index(fs->s, &size);
+
 	/* Look for exact matches, error if more than one. */
+	len = strlen(window);
+	i = cmd_find_name_lower(list, size, window, len + 1);
 	fs->wl = NULL;
-	RB_FOREACH(wl, winlinks, &fs->s->windows) {
-		if (strcmp(window, wl->window->name) == 0) {
-			if (fs->wl != NULL)
-				return (-1);
-			fs->wl = wl;
-		}
-	}
-	if (fs->wl != NULL) {
+	if (i < size && strcmp(window, list[i]->window->name) == 0) {
+		if (i + 1 < size &&
+		    strcmp(window, list[i + 1]->window->name) == 0)
+			return (-1);
+		fs->wl = list[i];
 		fs->idx = fs->wl->idx;
 		fs->w = fs->wl->window;
 		return (0);
@@ -463,23 +507,26 @@ cmd_find_get_window_with_session(struct cmd_find_state *fs, const char *window)
 		return (-1);
 
 	/* Try as the start of a window name, error if multiple. */
-	fs->wl = NULL;
-	RB_FOREACH(wl, winlinks, &fs->s->windows) {
-		if (strncmp(window, wl->window->name, strlen(window)) == 0) {
-			if (fs->wl != NULL)
-				return (-1);
-			fs->wl = wl;
-		}
-	}
-	if (fs->wl != NULL) {
+	if (i < size && strncmp(window, list[i]->window->name, len) == 0) {
+		if (i + 1 < size &&
+		    strncmp(window, list[i + 1]->window->name, len) == 0)
+			return (-1);
+		fs->wl = list[i];
 		fs->idx = fs->wl->idx;
 		fs->w = fs->wl->window;
 		return (0);
 	}
 
-	/* Now look for pattern matches, again error if multiple. */
-	fs->wl = NULL;
-	RB_FOREACH(wl, winlinks, &fs->s->windows) {
+	/*
+	 * Now look for pattern matches, again error if multiple. Only names
+	 * starting with the part of the pattern before any special characters
+	 * need to be checked.
+	 */
+	len = strcspn(window, "*?[\\");
+	for (i = cmd_find_name_lower(list, size, window, len); i < size; i++) {
+		wl = list[i];
+		if (strncmp(window, wl->window->name, len) != 0)
+			break;
 		if (fnmatch(window, wl->window->name, 0) == 0) {
 			if (fs->wl != NULL)
 				return (-1);
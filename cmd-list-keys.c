@@ -129,7 +129,7 @@ cmd_list_keys_exec(struct cmd *self, struct cmdq_item *item)
 			strlcat(tmp, " ", sizeof tmp);
 			free(cp);
 
-			cp = cmd_list_print(bd->cmdlist, 1);
+			cp = cmd_list_print(key_bindings_get_cmdlist(bd), 1);
 			strlcat(tmp, cp, sizeof tmp);
 			free(cp);
 
@@ -20,7 +20,6 @@
 #include <sys/socket.h>
 
 #include <errno.h>
-#include <fcntl.h>
 #include <signal.h>
 #include <stdlib.h>
 #include <string.h>
@@ -61,16 +60,14 @@ cmd_pipe_pane_exec(struct cmd *self, struct cmdq_item *item)
 	struct session		*s = item->target.s;
 	struct winlink		*wl = item->target.wl;
 	char			*cmd;
-	int			 old_fd, pipe_fd[2], null_fd, in, out;
+	int			 old_fd, pipe_fd[2], in, out;
 	struct format_tree	*ft;
 	sigset_t		 set, oldset;
 
 	/* Destroy the old pipe. */
 	old_fd = wp->pipe_fd;
 	if (wp->pipe_fd != -1) {
-		bufferevent_free(wp->pipe_event);
-		close(wp->pipe_fd);
-		wp->pipe_fd = -1;
+		window_pane_pipe_close(wp);
 
 		if (window_pane_destroy_ready(wp)) {
 			server_destroy_pane(wp, 1);
@@ -112,51 +109,26 @@ cmd_pipe_pane_exec(struct cmd *self, struct cmdq_item *item)
 	cmd = format_expand_time(ft, args->argv[0]);
 	format_free(ft);
 
-	/* Fork the child. */
+	/* Start the child. */
 	sigfillset(&set);
 	sigprocmask(SIG_BLOCK, &set, &oldset);
-	switch (fork()) {
+	switch (job_fork(cmd, NULL, NULL, out ? pipe_fd[1] : -1,
+	    in ? pipe_fd[1] : -1, &oldset)) {
 	case -1:
 		sigprocmask(SIG_SETMASK, &oldset, NULL);
 		cmdq_error(item, "fork error: %s", strerror(errno));
 
+		close(pipe_fd[0]);
+		close(pipe_fd[1]);
 		free(cmd);
 		return (CMD_RETURN_ERROR);
-	case 0:
-		/* Child process. */
-		proc_clear_signals(server_proc, 1);
-		sigprocmask(SIG_SETMASK, &oldset, NULL);
-		close(pipe_fd[0]);
-
-		null_fd = open(_PATH_DEVNULL, O_WRONLY, 0);
-		if (out) {
-			if (dup2(pipe_fd[1], STDIN_FILENO) == -1)
-				_exit(1);
-		} else {
-			if (dup2(null_fd, STDIN_FILENO) == -1)
-				_exit(1);
-		}
-		if (in) {
-			if (dup2(pipe_fd[1], STDOUT_FILENO) == -1)
-				_exit(1);
-			if (pipe_fd[1] != STDOUT_FILENO)
-				close(pipe_fd[1]);
-		} else {
-			if (dup2(null_fd, STDOUT_FILENO) == -1)
-				_exit(1);
-		}
-		if (dup2(null_fd, STDERR_FILENO) == -1)
-			_exit(1);
-		closefrom(STDERR_FILENO + 1);
-
-		execl(_PATH_BSHELL, "sh", "-c", cmd, (char *) NULL);
-		_exit(1);
 	default:
 		/* Parent process. */
 		sigprocmask(SIG_SETMASK, &oldset, NULL);
 		close(pipe_fd[1]);
 
 		wp->pipe_fd = pipe_fd[0];
+		wp->pipe_dropped = 0;
 		if (wp->fd != -1)
 			wp->pipe_off = EVBUFFER_LENGTH(wp->event->input);
 		else
@@ -203,6 +175,7 @@ cmd_pipe_pane_write_callback(__unused struct bufferevent *bufev, void *data)
 	struct window_pane	*wp = data;
 
 	log_debug("%%%u pipe empty", wp->id);
+	window_pane_pipe_written(wp);
 
 	if (window_pane_destroy_ready(wp))
 		server_destroy_pane(wp, 1);
@@ -215,10 +188,7 @@ cmd_pipe_pane_error_callback(__unused struct bufferevent *bufev,
 	struct window_pane	*wp = data;
 
 	log_debug("%%%u pipe error", wp->id);
-
-	bufferevent_free(wp->pipe_event);
-	close(wp->pipe_fd);
-	wp->pipe_fd = -1;
+	window_pane_pipe_close(wp);
 
 	if (window_pane_destroy_ready(wp))
 		server_destroy_pane(wp, 1);
@@ -0,0 +1,151 @@
+/* $OpenBSD$ */
+
+/*
+ * Copyright (c) 2026 Nicholas Marriott <nicholas.marriott@gmail.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF MIND, USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING
+ * OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "tmux.h"
+
+/*
+ * Save a pane's history and visible lines to a file, or add lines from a file
+ * to the history.
+ */
+
+static enum cmd_retval	cmd_save_history_exec(struct cmd *,
+			    struct cmdq_item *);
+
+const struct cmd_entry cmd_save_history_entry = {
+	.name = "save-history",
+	.alias = "saveh",
+
+	.args = { "t:", 1, 1 },
+	.usage = CMD_TARGET_PANE_USAGE " path",
+
+	.target = { 't', CMD_FIND_PANE, 0 },
+
+	.flags = CMD_AFTERHOOK,
+	.exec = cmd_save_history_exec
+};
+
+const struct cmd_entry cmd_load_history_entry = {
+	.name = "load-history",
+	.alias = "loadh",
+
+	.args = { "t:", 1, 1 },
+	.usage = CMD_TARGET_PANE_USAGE " path",
+
+	.target = { 't', CMD_FIND_PANE, 0 },
+
+	.flags = CMD_AFTERHOOK,
+	.exec = cmd_save_history_exec
+};
+
+static enum cmd_retval
+cmd_save_history_save(struct cmdq_item *item, struct window_pane *wp,
+    const char *file)
+{
+	FILE	*f;
+	int	 error;
+
+	f = fopen(file, "wb");
+	if (f == NULL) {
+		cmdq_error(item, "%s: %s", file, strerror(errno));
+		return (CMD_RETURN_ERROR);
+	}
+	error = grid_save(wp->base.grid, f);
+	if (fclose(f) != 0)
+		error = -1;
+	if (error != 0) {
+		cmdq_error(item, "%s: write error", file);
+		return (CMD_RETURN_ERROR);
+	}
+	return (CMD_RETURN_NORMAL);
+}
+
+static enum cmd_retval
+cmd_save_history_load(struct cmdq_item *item, struct window_pane *wp,
+    const char *file)
+{
+	struct stat	 sb;
+	void		*buf;
+	char		*cause;
+	int		 fd, error;
+
+	if ((fd = open(file, O_RDONLY)) == -1 || fstat(fd, &sb) != 0) {
+		cmdq_error(item, "%s: %s", file, strerror(errno));
+		if (fd != -1)
+			close(fd);
+		return (CMD_RETURN_ERROR);
+	}
+	if (sb.st_size == 0 || (uintmax_t)sb.st_size > SIZE_MAX) {
+		cmdq_error(item, "%s: not a saved history file", file);
+		close(fd);
+		return (CMD_RETURN_ERROR);
+	}
+
+	buf = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (buf == MAP_FAILED) {
+		cmdq_error(item, "%s: %s", file, strerror(errno));
+		return (CMD_RETURN_ERROR);
+	}
+	error = grid_load(wp->base.grid, buf, sb.st_size, &cause);
+	munmap(buf, sb.st_size);
+
+	if (error != 0) {
+		cmdq_error(item, "%s: %s", file, cause);
+		free(cause);
+		return (CMD_RETURN_ERROR);
+	}
+	window_collect_history();
+
+	wp->flags |= PANE_REDRAW;
+	return (CMD_RETURN_NORMAL);
+}
+
+static enum cmd_retval
+cmd_save_history_exec(struct cmd *self, struct cmdq_item *item)
+{
+	struct args		*args = self->args;
+	struct client		*c = cmd_find_client(item, NULL, 1);
+	struct session		*s = item->target.s;
+	struct winlink		*wl = item->target.wl;
+	struct window_pane	*wp = item->target.wp;
+	enum cmd_retval		 retval;
+	char			*path, *file;
+
+	path = format_single(item, args->argv[0], c, s, wl, wp);
+	file = server_client_get_path(item->client, path);
+	free(path);
+
+	if (self->entry == &cmd_load_history_entry)
+		retval = cmd_save_history_load(item, wp, file);
+	else
+		retval = cmd_save_history_save(item, wp, file);
+	free(file);
+	return (retval);
+}
@@ -253,10 +253,20 @@ cmd_set_option_exec(struct cmd *self, struct cmdq_item *item)
 		RB_FOREACH(wp, window_pane_tree, &all_window_panes)
 			wp->flags |= PANE_STYLECHANGED;
 	}
+	if (strcmp(name, "colour-approximation") == 0)
+		colour_set_approximation(options_get_number(oo, name));
 	if (strcmp(name, "pane-border-status") == 0) {
 		RB_FOREACH(w, windows, &windows)
 			layout_fix_panes(w);
 	}
+	if (strcmp(name, "pane-log-file") == 0) {
+		RB_FOREACH(wp, window_pane_tree, &all_window_panes)
+			pane_log_update(wp);
+	}
+	if (strcmp(name, "history-memory-limit") == 0) {
+		window_collect_history_reset();
+		window_collect_history();
+	}
 	RB_FOREACH(s, sessions, &sessions)
 		status_update_cache(s);
 
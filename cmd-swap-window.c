@@ -76,6 +76,8 @@ cmd_swap_window_exec(struct cmd *self, struct cmdq_item *item)
 	TAILQ_INSERT_TAIL(&w_src->winlinks, wl_dst, wentry);
 	wl_src->window = w_dst;
 	TAILQ_INSERT_TAIL(&w_dst->winlinks, wl_src, wentry);
+	src->name_index_valid = 0;
+	dst->name_index_valid = 0;
 
 	if (args_has(self->args, 'd')) {
 		session_select(dst, wl_dst->idx);
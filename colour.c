@@ -25,6 +25,18 @@
 
 #include "tmux.h"
 
+/*
+ * Cache of RGB to 256 colour conversions. Entries are keyed on the RGB colour
+ * with COLOUR_FLAG_RGB set so an empty entry never matches.
+ */
+#define COLOUR_CACHE_SIZE 4096
+struct colour_cache_entry {
+	int	rgb;
+	int	colour;
+};
+static struct colour_cache_entry colour_cache[COLOUR_CACHE_SIZE];
+static int colour_approximation = COLOUR_APPROXIMATE_NEAREST;
+
 static int
 colour_dist_sq(int R, int G, int B, int r, int g, int b)
 {
@@ -86,6 +98,98 @@ colour_find_rgb(u_char r, u_char g, u_char b)
 	return (idx | COLOUR_FLAG_256);
 }
 
+/* Weighted distance between two colours, closer to how they are seen. */
+static int
+colour_dist_perceptual(int R, int G, int B, int r, int g, int b)
+{
+	int	rmean = (R + r) / 2;
+
+	return ((((512 + rmean) * (R - r) * (R - r)) >> 8) +
+	    4 * (G - g) * (G - g) +
+	    (((767 - rmean) * (B - b) * (B - b)) >> 8));
+}
+
+/*
+ * Like colour_find_rgb but use a weighted distance and look at the
+ * neighbouring colours in the cube and the neighbouring greys as well. This is
+ * slower so should only be used through the cache.
+ */
+static int
+colour_find_rgb_perceptual(u_char r, u_char g, u_char b)
+{
+	static const int	q2c[6] = { 0x00, 0x5f, 0x87, 0xaf, 0xd7, 0xff };
+	int			qr, qg, qb, ir, ig, ib, grey, i, d, best, idx;
+
+	qr = colour_to_6cube(r);
+	qg = colour_to_6cube(g);
+	qb = colour_to_6cube(b);
+
+	best = -1;
+	idx = 0;
+	for (ir = qr - 1; ir <= qr + 1; ir++) {
+		if (ir < 0 || ir > 5)
+			continue;
+		for (ig = qg - 1; ig <= qg + 1; ig++) {
+			if (ig < 0 || ig > 5)
+				continue;
+			for (ib = qb - 1; ib <= qb + 1; ib++) {
+				if (ib < 0 || ib > 5)
+					continue;
+				d = colour_dist_perceptual(q2c[ir], q2c[ig],
+				    q2c[ib], r, g, b);
+				if (best == -1 || d < best) {
+					best = d;
+					idx = 16 + (36 * ir) + (6 * ig) + ib;
+				}
+			}
+		}
+	}
+
+	grey = ((r + g + b) / 3 - 3) / 10;
+	for (i = grey - 1; i <= grey + 1; i++) {
+		if (i < 0 || i > 23)
+			continue;
+		d = colour_dist_perceptual(8 + 10 * i, 8 + 10 * i, 8 + 10 * i,
+		    r, g, b);
+		if (d < best) {
+			best = d;
+			idx = 232 + i;
+		}
+	}
+	return (idx | COLOUR_FLAG_256);
+}
+
+/* Set how RGB colours are approximated and empty the cache if it changes. */
+void
+colour_set_approximation(int type)
+{
+	if (type != colour_approximation) {
+		colour_approximation = type;
+		memset(colour_cache, 0, sizeof colour_cache);
+	}
+}
+
+/* Convert an RGB colour to the 256 colour palette, using the cache. */
+int
+colour_RGBto256(int c)
+{
+	struct colour_cache_entry	*ce;
+	u_char				 r, g, b;
+
+	c = (c & 0xffffff) | COLOUR_FLAG_RGB;
+	ce = &colour_cache[((u_int)c * 2654435761U) >> 20];
+	if (ce->rgb == c)
+		return (ce->colour);
+
+	colour_split_rgb(c, &r, &g, &b);
+	ce->rgb = c;
+	if (colour_approximation == COLOUR_APPROXIMATE_PERCEPTUAL)
+		ce->colour = colour_find_rgb_perceptual(r, g, b);
+	else
+		ce->colour = colour_find_rgb(r, g, b);
+	return (ce->colour);
+}
+
 /* Join RGB into a colour. */
 int
 colour_join_rgb(u_char r, u_char g, u_char b)
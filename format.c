@@ -55,12 +55,18 @@ static void	 format_defaults_session(struct format_tree *,
 static void	 format_defaults_client(struct format_tree *, struct client *);
 static void	 format_defaults_winlink(struct format_tree *, struct winlink *);
 
-/* Entry in format job tree. */
+/*
+ * Entry in format job tree. Jobs are kept for each client unless the command
+ * does not use any client formats, in which case the client entry refers to a
+ * shared job keyed by the expanded command and working directory. The shared
+ * job is run once for all the clients using it.
+ */
 struct format_job {
 	struct client		*client;
 	u_int			 tag;
 	const char		*cmd;
 	const char		*expanded;
+	const char		*cwd;
 
 	time_t			 last;
 	char			*out;
@@ -69,6 +75,9 @@ struct format_job {
 	struct job		*job;
 	int			 status;
 
+	struct client		**clients;
+	u_int			 nclients;
+
 	RB_ENTRY(format_job)	 entry;
 };
 
@@ -78,6 +87,16 @@ static int format_job_cmp(struct format_job *, struct format_job *);
 static RB_HEAD(format_job_tree, format_job) format_jobs = RB_INITIALIZER();
 RB_GENERATE_STATIC(format_job_tree, format_job, entry, format_job_cmp);
 
+/* Shared format job tree. */
+static int format_shared_job_cmp(struct format_job *, struct format_job *);
+static RB_HEAD(format_shared_job_tree, format_job) format_shared_jobs =
+    RB_INITIALIZER();
+RB_GENERATE_STATIC(format_shared_job_tree, format_job, entry,
+    format_shared_job_cmp);
+
+/* Number of format jobs started. */
+static u_int format_job_runs;
+
 /* Format job tree comparison function. */
 static int
 format_job_cmp(struct format_job *fj1, struct format_job *fj2)
@@ -89,6 +108,17 @@ format_job_cmp(struct format_job *fj1, struct format_job *fj2)
 	return (strcmp(fj1->cmd, fj2->cmd));
 }
 
+/* Shared format job tree comparison function. */
+static int
+format_shared_job_cmp(struct format_job *fj1, struct format_job *fj2)
+{
+	int	retval;
+
+	if ((retval = strcmp(fj1->expanded, fj2->expanded)) != 0)
+		return (retval);
+	return (strcmp(fj1->cwd, fj2->cwd));
+}
+
 /* Format modifiers. */
 #define FORMAT_TIMESTRING 0x1
 #define FORMAT_BASENAME 0x2
@@ -241,6 +271,18 @@ format_log1(struct format_tree *ft, const char *from, const char *fmt, ...)
 }
 #define format_log(ft, fmt, ...) format_log1(ft, __func__, fmt, ##__VA_ARGS__)
 
+/* Redraw the status line of clients using a format job. */
+static void
+format_job_status(struct format_job *fj)
+{
+	u_int	i;
+
+	if (fj->client != NULL)
+		server_status_client(fj->client);
+	for (i = 0; i < fj->nclients; i++)
+		server_status_client(fj->clients[i]);
+}
+
 /* Format job update callback. */
 static void
 format_job_update(struct job *job)
@@ -265,8 +307,7 @@ format_job_update(struct job *job)
 
 	t = time(NULL);
 	if (fj->status && fj->last != t) {
-		if (fj->client != NULL)
-			server_status_client(fj->client);
+		format_job_status(fj);
 		fj->last = t;
 	}
 }
@@ -301,21 +342,98 @@ format_job_complete(struct job *job)
 		free(buf);
 
 	if (fj->status) {
-		if (fj->client != NULL)
-			server_status_client(fj->client);
+		format_job_status(fj);
 		fj->status = 0;
 	}
 }
 
+/* Start a format job. */
+static void
+format_job_run(struct format_job *fj, const char *cwd, time_t t)
+{
+	if (fj->job != NULL)
+		job_free(fj->job);
+	fj->job = job_run(fj->expanded, NULL, cwd, format_job_update,
+	    format_job_complete, NULL, fj, JOB_NOWAIT);
+	if (fj->job == NULL) {
+		free(fj->out);
+		xasprintf(&fj->out, "<'%s' didn't start>", fj->cmd);
+	} else
+		format_job_runs++;
+	fj->last = t;
+	fj->updated = 0;
+}
+
+/* Add a client to those to be told when a shared job has new output. */
+static void
+format_job_add_client(struct format_job *sfj, struct client *c)
+{
+	u_int	i;
+
+	for (i = 0; i < sfj->nclients; i++) {
+		if (sfj->clients[i] == c)
+			return;
+	}
+	sfj->clients = xreallocarray(sfj->clients, sfj->nclients + 1,
+	    sizeof *sfj->clients);
+	sfj->clients[sfj->nclients++] = c;
+}
+
+/* Remove a client from a shared job. */
+static void
+format_job_remove_client(struct format_job *sfj, struct client *c)
+{
+	u_int	i;
+
+	for (i = 0; i < sfj->nclients; i++) {
+		if (sfj->clients[i] != c)
+			continue;
+		sfj->clients[i] = sfj->clients[--sfj->nclients];
+		return;
+	}
+}
+
+/* Find or start the shared job for a client job. */
+static struct format_job *
+format_job_get_shared(struct format_tree *ft, struct format_job *fj)
+{
+	struct format_job	 sfj0, *sfj;
+	time_t			 t;
+	const char		*cwd;
+
+	cwd = server_client_get_cwd(ft->client, NULL);
+	sfj0.expanded = fj->expanded;
+	sfj0.cwd = cwd;
+	if ((sfj = RB_FIND(format_shared_job_tree, &format_shared_jobs,
+	    &sfj0)) == NULL) {
+		sfj = xcalloc(1, sizeof *sfj);
+		sfj->cmd = xstrdup(fj->cmd);
+		sfj->expanded = xstrdup(fj->expanded);
+		sfj->cwd = xstrdup(cwd);
+		RB_INSERT(format_shared_job_tree, &format_shared_jobs, sfj);
+	}
+
+	t = time(NULL);
+	if ((ft->flags & FORMAT_FORCE) ||
+	    (sfj->job == NULL && sfj->last != t))
+		format_job_run(sfj, cwd, t);
+
+	if (ft->flags & FORMAT_STATUS) {
+		sfj->status = 1;
+		format_job_add_client(sfj, ft->client);
+	}
+	return (sfj);
+}
+
 /* Find a job. */
 static char *
 format_job_get(struct format_tree *ft, const char *cmd)
 {
 	struct format_job_tree	*jobs;
-	struct format_job	 fj0, *fj;
+	struct format_job	 fj0, *fj, *sfj;
 	time_t			 t;
 	char			*expanded;
-	int			 force;
+	int			 force, changed;
 
 	if (ft->client == NULL)
 		jobs = &format_jobs;
@@ -341,35 +459,57 @@ format_job_get(struct format_tree *ft, const char *cmd)
 	}
 
 	expanded = format_expand(ft, cmd);
-	if (fj->expanded == NULL || strcmp(expanded, fj->expanded) != 0) {
+	changed = (fj->expanded == NULL || strcmp(expanded, fj->expanded) != 0);
+	if (changed) {
 		free((void *)fj->expanded);
 		fj->expanded = xstrdup(expanded);
-		force = 1;
-	} else
-		force = (ft->flags & FORMAT_FORCE);
+	}
+	free(expanded);
 
-	t = time(NULL);
-	if (force && fj->job != NULL)
-	       job_free(fj->job);
-	if (force || (fj->job == NULL && fj->last != t)) {
-		fj->job = job_run(expanded, NULL,
-		    server_client_get_cwd(ft->client, NULL), format_job_update,
-		    format_job_complete, NULL, fj, JOB_NOWAIT);
-		if (fj->job == NULL) {
+	/*
+	 * Share the job with other clients if it doesn't use any client
+	 * formats. The client keeps the last output so it has something to
+	 * show while a new shared job starts.
+	 */
+	if (ft->client != NULL && strstr(cmd, "client_") == NULL) {
+		sfj = format_job_get_shared(ft, fj);
+		if (sfj->out != NULL && (sfj->job == NULL || sfj->updated)) {
 			free(fj->out);
-			xasprintf(&fj->out, "<'%s' didn't start>", fj->cmd);
+			fj->out = xstrdup(sfj->out);
 		}
-		fj->last = t;
-		fj->updated = 0;
+		fj->last = sfj->last;
+		return (format_expand(ft, fj->out));
 	}
 
+	force = changed || (ft->flags & FORMAT_FORCE);
+	t = time(NULL);
+	if (force || (fj->job == NULL && fj->last != t))
+		format_job_run(fj, server_client_get_cwd(ft->client, NULL), t);
+
 	if (ft->flags & FORMAT_STATUS)
 		fj->status = 1;
 
-	free(expanded);
 	return (format_expand(ft, fj->out));
 }
 
+/* Free a job. */
+static void
+format_job_free(struct format_job *fj)
+{
+	log_debug("%s: %s", __func__, fj->cmd);
+
+	if (fj->job != NULL)
+		job_free(fj->job);
+
+	free((void *)fj->expanded);
+	free((void *)fj->cwd);
+	free((void *)fj->cmd);
+	free(fj->out);
+	free(fj->clients);
+
+	free(fj);
+}
+
 /* Remove old jobs. */
 static void
 format_job_tidy(struct format_job_tree *jobs, int force)
@@ -382,17 +522,23 @@ format_job_tidy(struct format_job_tree *jobs, int force)
 		if (!force && (fj->last > now || now - fj->last < 3600))
 			continue;
 		RB_REMOVE(format_job_tree, jobs, fj);
+		format_job_free(fj);
+	}
+}
 
-		log_debug("%s: %s", __func__, fj->cmd);
-
-		if (fj->job != NULL)
-			job_free(fj->job);
-
-		free((void *)fj->expanded);
-		free((void *)fj->cmd);
-		free(fj->out);
+/* Remove old shared jobs. */
+static void
+format_job_tidy_shared(void)
+{
+	struct format_job	*fj, *fj1;
+	time_t			 now;
 
-		free(fj);
+	now = time(NULL);
+	RB_FOREACH_SAFE(fj, format_shared_job_tree, &format_shared_jobs, fj1) {
+		if (fj->last > now || now - fj->last < 3600)
+			continue;
+		RB_REMOVE(format_shared_job_tree, &format_shared_jobs, fj);
+		format_job_free(fj);
 	}
 }
 
@@ -400,6 +546,11 @@ format_job_tidy(struct format_job_tree *jobs, int force)
 void
 format_lost_client(struct client *c)
 {
+	struct format_job	*fj;
+
+	RB_FOREACH(fj, format_shared_job_tree, &format_shared_jobs)
+		format_job_remove_client(fj, c);
+
 	if (c->jobs != NULL)
 		format_job_tidy(c->jobs, 1);
 	free(c->jobs);
@@ -417,11 +568,33 @@ format_job_timer(__unused int fd, __unused short events, __unused void *arg)
 		if (c->jobs != NULL)
 			format_job_tidy(c->jobs, 0);
 	}
+	format_job_tidy_shared();
 
 	evtimer_del(&format_job_event);
 	evtimer_add(&format_job_event, &tv);
 }
 
+/* Callback for number of format jobs. */
+static void
+format_cb_format_jobs(__unused struct format_tree *ft, struct format_entry *fe)
+{
+	struct format_job	*fj;
+	struct client		*c;
+	u_int			 n = 0;
+
+	RB_FOREACH(fj, format_job_tree, &format_jobs)
+		n += (fj->job != NULL);
+	RB_FOREACH(fj, format_shared_job_tree, &format_shared_jobs)
+		n += (fj->job != NULL);
+	TAILQ_FOREACH(c, &clients, entry) {
+		if (c->jobs == NULL)
+			continue;
+		RB_FOREACH(fj, format_job_tree, c->jobs)
+			n += (fj->job != NULL);
+	}
+	xasprintf(&fe->value, "%u", n);
+}
+
 /* Callback for host. */
 static void
 format_cb_host(__unused struct format_tree *ft, struct format_entry *fe)
@@ -605,29 +778,21 @@ format_cb_current_path(struct format_tree *ft, struct format_entry *fe)
 		fe->value = xstrdup(cwd);
 }
 
-/* Callback for history_bytes. */
+/* Callback for history_share. */
 static void
-format_cb_history_bytes(struct format_tree *ft, struct format_entry *fe)
+format_cb_history_share(struct format_tree *ft, struct format_entry *fe)
 {
 	struct window_pane	*wp = ft->wp;
-	struct grid		*gd;
-	struct grid_line	*gl;
-	unsigned long long	 size;
-	u_int			 i;
+	unsigned long long	 total;
+	u_int			 share = 0;
 
 	if (wp == NULL)
 		return;
-	gd = wp->base.grid;
-
-	size = 0;
-	for (i = 0; i < gd->hsize; i++) {
-		gl = grid_get_line(gd, i);
-		size += gl->cellsize * sizeof *gl->celldata;
-		size += gl->extdsize * sizeof *gl->extddata;
-	}
-	size += gd->hsize * sizeof *gl;
 
-	xasprintf(&fe->value, "%llu", size);
+	total = grid_history_total_bytes();
+	if (total != 0)
+		share = grid_history_bytes(wp->base.grid) * 100 / total;
+	xasprintf(&fe->value, "%u", share);
 }
 
 /* Callback for pane_tabs. */
@@ -904,6 +1069,8 @@ format_create(struct client *c, struct cmdq_item *item, int tag, int flags)
 	format_add_cb(ft, "host", format_cb_host);
 	format_add_cb(ft, "host_short", format_cb_host_short);
 	format_add_cb(ft, "pid", format_cb_pid);
+	format_add_cb(ft, "format_jobs", format_cb_format_jobs);
+	format_add(ft, "format_job_runs", "%u", format_job_runs);
 	format_add(ft, "socket_path", "%s", socket_path);
 	format_add_tv(ft, "start_time", &start_time);
 
@@ -2133,6 +2300,8 @@ format_defaults_client(struct format_tree *ft, struct client *c)
 
 	format_add(ft, "client_written", "%zu", c->written);
 	format_add(ft, "client_discarded", "%zu", c->discarded);
+	format_add(ft, "client_writes", "%u", c->writes);
+	format_add(ft, "client_write_latency", "%u", c->write_latency);
 
 	name = server_client_get_key_table(c);
 	if (strcmp(c->keytable->name, name) == 0)
@@ -2245,7 +2414,10 @@ format_defaults_pane(struct format_tree *ft, struct window_pane *wp)
 
 	format_add(ft, "history_size", "%u", gd->hsize);
 	format_add(ft, "history_limit", "%u", gd->hlimit);
-	format_add_cb(ft, "history_bytes", format_cb_history_bytes);
+	format_add(ft, "history_bytes", "%llu", grid_history_bytes(gd));
+	format_add(ft, "history_cold_bytes", "%llu", grid_cold_bytes(gd));
+	format_add(ft, "history_all_bytes", "%llu", grid_history_total_bytes());
+	format_add_cb(ft, "history_share", format_cb_history_share);
 
 	if (window_pane_index(wp, &idx) != 0)
 		fatalx("index not found");
@@ -2258,6 +2430,9 @@ format_defaults_pane(struct format_tree *ft, struct window_pane *wp)
 	format_add(ft, "pane_active", "%d", wp == w->active);
 	format_add(ft, "pane_input_off", "%d", !!(wp->flags & PANE_INPUTOFF));
 	format_add(ft, "pane_pipe", "%d", wp->pipe_fd != -1);
+	format_add(ft, "pane_pipe_backlog", "%zu",
+	    window_pane_pipe_backlog(wp));
+	format_add(ft, "pane_pipe_dropped", "%lu", wp->pipe_dropped);
 
 	if ((wp->flags & PANE_STATUSREADY) && WIFEXITED(status))
 		format_add(ft, "pane_dead_status", "%d", WEXITSTATUS(status));
@@ -0,0 +1,345 @@
+/* $OpenBSD$ */
+
+/*
+ * Copyright (c) 2026 Nicholas Marriott <nicholas.marriott@gmail.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF MIND, USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING
+ * OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <sys/mman.h>
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "tmux.h"
+
+/*
+ * Cold history. Lines older than a limit are copied into an unlinked
+ * temporary file and their cell data freed. The file is made up of fixed size
+ * chunks, each mapped into memory, and the line's celldata and extddata are
+ * pointed at its copy in the mapping, so reading a cold line is the same as
+ * reading any other and the kernel may drop the pages when memory is short.
+ *
+ * Before a cold line is changed, it is copied back into the heap
+ * (grid_cold_thaw). A chunk is reused once none of its lines are still cold.
+ */
+
+/* Size of each chunk of the file, a multiple of any page size. */
+#define GRID_COLD_CHUNK (1024 * 1024)
+
+struct grid_cold_chunk {
+	u_char				*base;
+	off_t				 offset;
+	size_t				 used;
+	u_int				 lines;
+
+	RB_ENTRY(grid_cold_chunk)	 entry;
+};
+RB_HEAD(grid_cold_chunks, grid_cold_chunk);
+
+/* Bytes of cold lines in all grids. */
+static unsigned long long grid_cold_total;
+
+struct grid_cold {
+	int				 fd;
+	u_int				 limit;
+
+	off_t				 size;
+	off_t				*free;
+	u_int				 nfree;
+
+	struct grid_cold_chunk		*current;
+	struct grid_cold_chunks		 chunks;
+
+	u_int				 lines;
+	unsigned long long		 bytes;
+};
+
+/*
+ * Chunks do not overlap, so compare by address and treat any address inside a
+ * chunk as equal to it.
+ */
+static int
+grid_cold_cmp(struct grid_cold_chunk *gcc1, struct grid_cold_chunk *gcc2)
+{
+	if (gcc1->base < gcc2->base)
+		return (-1);
+	if (gcc1->base >= gcc2->base + GRID_COLD_CHUNK)
+		return (1);
+	return (0);
+}
+RB_GENERATE_STATIC(grid_cold_chunks, grid_cold_chunk, entry, grid_cold_cmp);
+
+/* Get size of a line's data. */
+static size_t
+grid_cold_line_size(struct grid_line *gl)
+{
+	return (gl->cellsize * sizeof *gl->celldata +
+	    gl->extdsize * sizeof *gl->extddata);
+}
+
+/* Find the chunk holding a cold line. */
+static struct grid_cold_chunk *
+grid_cold_find(struct grid_cold *gco, struct grid_line *gl)
+{
+	struct grid_cold_chunk	find;
+
+	find.base = (u_char *)gl->celldata;
+	return (RB_FIND(grid_cold_chunks, &gco->chunks, &find));
+}
+
+/* Unmap a chunk and keep its space in the file for reuse. */
+static void
+grid_cold_free_chunk(struct grid_cold *gco, struct grid_cold_chunk *gcc)
+{
+	RB_REMOVE(grid_cold_chunks, &gco->chunks, gcc);
+	munmap(gcc->base, GRID_COLD_CHUNK);
+
+	gco->free = xreallocarray(gco->free, gco->nfree + 1,
+	    sizeof *gco->free);
+	gco->free[gco->nfree++] = gcc->offset;
+
+	if (gco->current == gcc)
+		gco->current = NULL;
+	free(gcc);
+}
+
+/*
+ * Start a new chunk, reusing free space in the file if any. New space is
+ * filled with zeroes so it is allocated now; writing through a mapping into a
+ * hole when the disk is full would be fatal.
+ */
+static struct grid_cold_chunk *
+grid_cold_new_chunk(struct grid_cold *gco)
+{
+	struct grid_cold_chunk	*gcc;
+	off_t			 offset;
+	char			*zero;
+	size_t			 done;
+	ssize_t			 n;
+	void			*base;
+
+	if (gco->nfree != 0)
+		offset = gco->free[--gco->nfree];
+	else {
+		offset = gco->size;
+
+		zero = xcalloc(1, 65536);
+		for (done = 0; done < GRID_COLD_CHUNK; done += n) {
+			n = pwrite(gco->fd, zero, 65536, offset + done);
+			if (n <= 0) {
+				log_debug("%s: write failed: %s", __func__,
+				    strerror(errno));
+				free(zero);
+				return (NULL);
+			}
+		}
+		free(zero);
+		gco->size += GRID_COLD_CHUNK;
+	}
+
+	base = mmap(NULL, GRID_COLD_CHUNK, PROT_READ|PROT_WRITE, MAP_SHARED,
+	    gco->fd, offset);
+	if (base == MAP_FAILED) {
+		log_debug("%s: mmap failed: %s", __func__, strerror(errno));
+		gco->free = xreallocarray(gco->free, gco->nfree + 1,
+		    sizeof *gco->free);
+		gco->free[gco->nfree++] = offset;
+		return (NULL);
+	}
+
+	gcc = xcalloc(1, sizeof *gcc);
+	gcc->base = base;
+	gcc->offset = offset;
+	RB_INSERT(grid_cold_chunks, &gco->chunks, gcc);
+	return (gcc);
+}
+
+/* Move a line to the file. */
+static void
+grid_cold_freeze(struct grid_cold *gco, struct grid_line *gl)
+{
+	struct grid_cold_chunk	*gcc;
+	size_t			 size, cellsize, extdsize;
+
+	if (gl->flags & (GRID_LINE_COLD|GRID_LINE_DEAD))
+		return;
+	size = grid_cold_line_size(gl);
+	if (size == 0 || size > GRID_COLD_CHUNK)
+		return;
+
+	gcc = gco->current;
+	if (gcc == NULL || gcc->used + size > GRID_COLD_CHUNK) {
+		if (gcc != NULL && gcc->lines == 0)
+			grid_cold_free_chunk(gco, gcc);
+		if ((gcc = grid_cold_new_chunk(gco)) == NULL)
+			return;
+		gco->current = gcc;
+	}
+
+	cellsize = gl->cellsize * sizeof *gl->celldata;
+	memcpy(gcc->base + gcc->used, gl->celldata, cellsize);
+	free(gl->celldata);
+	gl->celldata = (struct grid_cell_entry *)(gcc->base + gcc->used);
+
+	extdsize = gl->extdsize * sizeof *gl->extddata;
+	if (extdsize != 0) {
+		memcpy(gcc->base + gcc->used + cellsize, gl->extddata,
+		    extdsize);
+		free(gl->extddata);
+		gl->extddata = (struct grid_cell *)(gcc->base + gcc->used +
+		    cellsize);
+	}
+
+	gl->flags |= GRID_LINE_COLD;
+	gcc->used += size;
+	gcc->lines++;
+
+	gco->lines++;
+	gco->bytes += size;
+	grid_cold_total += size;
+}
+
+/* Start moving history lines older than limit to a file. */
+void
+grid_cold_enable(struct grid *gd, u_int limit)
+{
+	struct grid_cold	*gco;
+	char			 path[] = _PATH_TMP "tmux-history.XXXXXXXX";
+	int			 fd;
+
+	if (gd->cold != NULL || limit == 0)
+		return;
+
+	if ((fd = mkstemp(path)) == -1) {
+		log_debug("%s: %s: %s", __func__, path, strerror(errno));
+		return;
+	}
+	unlink(path);
+
+	gco = xcalloc(1, sizeof *gco);
+	gco->fd = fd;
+	gco->limit = limit;
+	RB_INIT(&gco->chunks);
+	gd->cold = gco;
+
+	grid_cold_sweep(gd);
+}
+
+/* Free the file. Any cold lines must already have been released. */
+void
+grid_cold_free(struct grid *gd)
+{
+	struct grid_cold	*gco = gd->cold;
+	struct grid_cold_chunk	*gcc, *gcc1;
+
+	if (gco == NULL)
+		return;
+	gd->cold = NULL;
+
+	RB_FOREACH_SAFE(gcc, grid_cold_chunks, &gco->chunks, gcc1) {
+		RB_REMOVE(grid_cold_chunks, &gco->chunks, gcc);
+		munmap(gcc->base, GRID_COLD_CHUNK);
+		free(gcc);
+	}
+	close(gco->fd);
+	free(gco->free);
+	free(gco);
+}
+
+/* Forget a cold line which is about to be freed or replaced. */
+void
+grid_cold_release(struct grid *gd, struct grid_line *gl)
+{
+	struct grid_cold	*gco = gd->cold;
+	struct grid_cold_chunk	*gcc;
+
+	gl->flags &= ~GRID_LINE_COLD;
+	if (gco == NULL || (gcc = grid_cold_find(gco, gl)) == NULL)
+		fatalx("cold line not found");
+
+	gco->lines--;
+	gco->bytes -= grid_cold_line_size(gl);
+	grid_cold_total -= grid_cold_line_size(gl);
+
+	if (--gcc->lines == 0 && gcc != gco->current)
+		grid_cold_free_chunk(gco, gcc);
+}
+
+/* Copy a cold line back into the heap so it may be changed. */
+void
+grid_cold_thaw(struct grid *gd, struct grid_line *gl)
+{
+	struct grid_line	cold;
+
+	memcpy(&cold, gl, sizeof cold);
+
+	gl->celldata = xreallocarray(NULL, gl->cellsize,
+	    sizeof *gl->celldata);
+	memcpy(gl->celldata, cold.celldata,
+	    gl->cellsize * sizeof *gl->celldata);
+	if (gl->extdsize != 0) {
+		gl->extddata = xreallocarray(NULL, gl->extdsize,
+		    sizeof *gl->extddata);
+		memcpy(gl->extddata, cold.extddata,
+		    gl->extdsize * sizeof *gl->extddata);
+	}
+	gl->flags &= ~(GRID_LINE_COLD|GRID_LINE_ROUNDED);
+
+	grid_cold_release(gd, &cold);
+}
+
+/* A line has been added to the history, so freeze the line now too old. */
+void
+grid_cold_scrolled(struct grid *gd)
+{
+	struct grid_cold	*gco = gd->cold;
+	u_int			 yy;
+
+	if (gd->hsize > gco->limit) {
+		yy = gd->hsize - gco->limit - 1;
+		grid_cold_freeze(gco, &gd->linedata[yy]);
+	}
+}
+
+/* Freeze every line that is too old, after lines have been added or moved. */
+void
+grid_cold_sweep(struct grid *gd)
+{
+	struct grid_cold	*gco = gd->cold;
+	u_int			 yy;
+
+	if (gco == NULL || gd->hsize <= gco->limit)
+		return;
+	for (yy = 0; yy < gd->hsize - gco->limit; yy++)
+		grid_cold_freeze(gco, &gd->linedata[yy]);
+}
+
+/* Get the number of bytes of cold lines held in the file. */
+unsigned long long
+grid_cold_bytes(struct grid *gd)
+{
+	if (gd->cold == NULL)
+		return (0);
+	return (gd->cold->bytes);
+}
+
+/* Get the number of bytes of cold lines in all grids. */
+unsigned long long
+grid_cold_total_bytes(void)
+{
+	return (grid_cold_total);
+}
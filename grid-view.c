@@ -48,10 +48,11 @@ grid_view_set_cell(struct grid *gd, u_int px, u_int py,
 /* Set cells. */
 void
 grid_view_set_cells(struct grid *gd, u_int px, u_int py,
-    const struct grid_cell *gc, const char *s, size_t slen)
+    const struct grid_cell *gc, const char *s, size_t slen,
+    const u_char *widths)
 {
 	grid_set_cells(gd, grid_view_x(gd, px), grid_view_y(gd, py), gc, s,
-	    slen);
+	    slen, widths);
 }
 
 /* Clear into history. */
@@ -18,6 +18,7 @@
 
 #include <sys/types.h>
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -44,12 +45,103 @@ const struct grid_cell grid_default_cell = {
 const struct grid_cell grid_cleared_cell = {
 	{ { ' ' }, 0, 1, 1 }, 0, GRID_FLAG_CLEARED, 8, 8, 0
 };
+/* Padding cell following a wide character. */
+const struct grid_cell grid_padding_cell = {
+	{ { 0 }, 0, 0, 0 }, 0, GRID_FLAG_PADDING, 0, 8, 8
+};
+
 static const struct grid_cell_entry grid_cleared_entry = {
 	GRID_FLAG_CLEARED, { .data = { 0, 8, 8, ' ' } }
 };
 
+/*
+ * Saved grid. A header is followed by each line: a struct grid_save_line then
+ * the cell entries and extended cells exactly as they are stored in memory.
+ * The sizes in the header mean a file is only loaded by a build with the same
+ * layout.
+ */
+#define GRID_SAVE_MAGIC "tmuxgrid"
+#define GRID_SAVE_VERSION 1
+struct grid_save_header {
+	char	magic[8];
+	u_int	version;
+	u_int	entry_size;
+	u_int	cell_size;
+	u_int	sx;
+	u_int	lines;
+} __packed;
+struct grid_save_line {
+	u_int	cellused;
+	u_int	cellsize;
+	u_int	extdsize;
+	int	flags;
+} __packed;
+
+/*
+ * Size of history lines in all grids, including cold lines, kept up to date as
+ * lines enter and leave the history.
+ */
+static unsigned long long grid_history_total;
+
 static void	grid_empty_line(struct grid *, u_int, u_int);
 
+/* Get the size of a history line. */
+static size_t
+grid_history_line_size(struct grid_line *gl)
+{
+	return (sizeof *gl + gl->cellsize * sizeof *gl->celldata +
+	    gl->extdsize * sizeof *gl->extddata);
+}
+
+/* Count lines added to the history. */
+static void
+grid_history_add(struct grid *gd, u_int py, u_int ny)
+{
+	size_t	size = 0;
+	u_int	yy;
+
+	for (yy = py; yy < py + ny; yy++)
+		size += grid_history_line_size(&gd->linedata[yy]);
+	gd->hbytes += size;
+	grid_history_total += size;
+}
+
+/* Count lines removed from the history. */
+static void
+grid_history_remove(struct grid *gd, u_int py, u_int ny)
+{
+	size_t	size = 0;
+	u_int	yy;
+
+	for (yy = py; yy < py + ny; yy++)
+		size += grid_history_line_size(&gd->linedata[yy]);
+	gd->hbytes -= size;
+	grid_history_total -= size;
+}
+
+/* Thaw any cold lines which are no longer in the history. */
+static void
+grid_history_thaw(struct grid *gd, u_int py, u_int ny)
+{
+	struct grid_line	*gl;
+	u_int			 yy;
+
+	for (yy = py; yy < py + ny; yy++) {
+		gl = &gd->linedata[yy];
+		if (gl->flags & GRID_LINE_COLD)
+			grid_cold_thaw(gd, gl);
+	}
+}
+
+/* Count the history again after it has been rebuilt. */
+static void
+grid_history_recount(struct grid *gd)
+{
+	grid_history_total -= gd->hbytes;
+	gd->hbytes = 0;
+	grid_history_add(gd, 0, gd->hsize);
+}
+
 /* Store cell in entry. */
 static void
 grid_store_cell(struct grid_cell_entry *gce, const struct grid_cell *gc,
@@ -87,6 +179,38 @@ grid_need_extended_cell(const struct grid_cell_entry *gce,
 	return (0);
 }
 
+/*
+ * Get the number of extended cells allocated. While a line is being written,
+ * the extended cells are allocated in powers of two (GRID_LINE_ROUNDED) so
+ * they are not reallocated for every new cell; when the line is compacted,
+ * they are allocated exactly.
+ */
+static u_int
+grid_extended_space(struct grid_line *gl)
+{
+	u_int	size;
+
+	if (~gl->flags & GRID_LINE_ROUNDED)
+		return (gl->extdsize);
+	for (size = 4; size < gl->extdsize; size *= 2)
+		/* nothing */;
+	return (size);
+}
+
+/* Make sure there is space for a number of extended cells. */
+static void
+grid_reserve_extended(struct grid_line *gl, u_int n)
+{
+	u_int	size;
+
+	if (n <= grid_extended_space(gl))
+		return;
+	for (size = 4; size < n; size *= 2)
+		/* nothing */;
+	gl->extddata = xreallocarray(gl->extddata, size, sizeof *gl->extddata);
+	gl->flags |= GRID_LINE_ROUNDED;
+}
+
 /* Get an extended cell. */
 static void
 grid_get_extended_cell(struct grid_line *gl, struct grid_cell_entry *gce,
@@ -94,7 +218,7 @@ grid_get_extended_cell(struct grid_line *gl, struct grid_cell_entry *gce,
 {
 	u_int at = gl->extdsize + 1;
 
-	gl->extddata = xreallocarray(gl->extddata, at, sizeof *gl->extddata);
+	grid_reserve_extended(gl, at);
 	gl->extdsize = at;
 
 	gce->offset = at - 1;
@@ -121,46 +245,82 @@ grid_extended_cell(struct grid_line *gl, struct grid_cell_entry *gce,
 	return (gcp);
 }
 
-/* Free up unused extended cells. */
+/*
+ * Free up unused extended cells. Cells are usually written from left to
+ * right, so their extended cells are in the same order and can be moved down
+ * in place; if not, they are copied into a new array.
+ */
 static void
 grid_compact_line(struct grid_line *gl)
 {
-	int			 new_extdsize = 0;
+	u_int			 new_extdsize = 0, next = 0, px, idx;
 	struct grid_cell	*new_extddata;
 	struct grid_cell_entry	*gce;
 	struct grid_cell	*gc;
-	u_int			 px, idx;
+	int			 ordered = 1;
 
-	if (gl->extdsize == 0)
+	if (gl->extdsize == 0 || (gl->flags & GRID_LINE_COLD))
 		return;
 
 	for (px = 0; px < gl->cellsize; px++) {
 		gce = &gl->celldata[px];
-		if (gce->flags & GRID_FLAG_EXTENDED)
+		if (gce->flags & GRID_FLAG_EXTENDED) {
+			if (gce->offset < next)
+				ordered = 0;
+			next = gce->offset + 1;
 			new_extdsize++;
+		}
 	}
 
 	if (new_extdsize == 0) {
 		free(gl->extddata);
 		gl->extddata = NULL;
 		gl->extdsize = 0;
+		gl->flags &= ~GRID_LINE_ROUNDED;
 		return;
 	}
-	new_extddata = xreallocarray(NULL, new_extdsize, sizeof *gl->extddata);
 
-	idx = 0;
-	for (px = 0; px < gl->cellsize; px++) {
-		gce = &gl->celldata[px];
-		if (gce->flags & GRID_FLAG_EXTENDED) {
-			gc = &gl->extddata[gce->offset];
-			memcpy(&new_extddata[idx], gc, sizeof *gc);
-			gce->offset = idx++;
+	if (new_extdsize != gl->extdsize && !ordered) {
+		new_extddata = xreallocarray(NULL, new_extdsize,
+		    sizeof *gl->extddata);
+
+		idx = 0;
+		for (px = 0; px < gl->cellsize; px++) {
+			gce = &gl->celldata[px];
+			if (gce->flags & GRID_FLAG_EXTENDED) {
+				gc = &gl->extddata[gce->offset];
+				memcpy(&new_extddata[idx], gc, sizeof *gc);
+				gce->offset = idx++;
+			}
 		}
+
+		free(gl->extddata);
+		gl->extddata = new_extddata;
+		gl->extdsize = new_extdsize;
+		gl->flags &= ~GRID_LINE_ROUNDED;
+		return;
 	}
 
-	free(gl->extddata);
-	gl->extddata = new_extddata;
-	gl->extdsize = new_extdsize;
+	if (new_extdsize != gl->extdsize) {
+		idx = 0;
+		for (px = 0; px < gl->cellsize; px++) {
+			gce = &gl->celldata[px];
+			if (~gce->flags & GRID_FLAG_EXTENDED)
+				continue;
+			if (gce->offset != idx) {
+				memcpy(&gl->extddata[idx],
+				    &gl->extddata[gce->offset],
+				    sizeof *gl->extddata);
+			}
+			gce->offset = idx++;
+		}
+		gl->extdsize = new_extdsize;
+	}
+	if (gl->flags & GRID_LINE_ROUNDED) {
+		gl->extddata = xreallocarray(gl->extddata, gl->extdsize,
+		    sizeof *gl->extddata);
+		gl->flags &= ~GRID_LINE_ROUNDED;
+	}
 }
 
 /* Get line data. */
@@ -230,10 +390,17 @@ grid_cells_equal(const struct grid_cell *gca, const struct grid_cell *gcb)
 static void
 grid_free_line(struct grid *gd, u_int py)
 {
-	free(gd->linedata[py].celldata);
-	gd->linedata[py].celldata = NULL;
-	free(gd->linedata[py].extddata);
-	gd->linedata[py].extddata = NULL;
+	struct grid_line	*gl = &gd->linedata[py];
+
+	if (gl->flags & GRID_LINE_COLD)
+		grid_cold_release(gd, gl);
+	else {
+		free(gl->celldata);
+		free(gl->extddata);
+	}
+	gl->celldata = NULL;
+	gl->extddata = NULL;
+	gl->flags &= ~GRID_LINE_ROUNDED;
 }
 
 /* Free several lines. */
@@ -261,6 +428,10 @@ grid_create(u_int sx, u_int sy, u_int hlimit)
 	gd->hscrolled = 0;
 	gd->hsize = 0;
 	gd->hlimit = hlimit;
+	gd->htrimmed = 0;
+
+	gd->hbytes = 0;
+	gd->cold = NULL;
 
 	if (gd->sy != 0)
 		gd->linedata = xcalloc(gd->sy, sizeof *gd->linedata);
@@ -274,7 +445,9 @@ grid_create(u_int sx, u_int sy, u_int hlimit)
 void
 grid_destroy(struct grid *gd)
 {
+	grid_history_total -= gd->hbytes;
 	grid_free_lines(gd, 0, gd->hsize + gd->sy);
+	grid_cold_free(gd);
 
 	free(gd->linedata);
 
@@ -312,9 +485,11 @@ grid_compare(struct grid *ga, struct grid *gb)
 static void
 grid_trim_history(struct grid *gd, u_int ny)
 {
+	grid_history_remove(gd, 0, ny);
 	grid_free_lines(gd, 0, ny);
 	memmove(&gd->linedata[0], &gd->linedata[ny],
 	    (gd->hsize + gd->sy - ny) * (sizeof *gd->linedata));
+	gd->htrimmed += ny;
 }
 
 /*
@@ -362,7 +537,11 @@ grid_scroll_history(struct grid *gd, u_int bg)
 
 	gd->hscrolled++;
 	grid_compact_line(&gd->linedata[gd->hsize]);
+	grid_history_add(gd, gd->hsize, 1);
 	gd->hsize++;
+
+	if (gd->cold != NULL)
+		grid_cold_scrolled(gd);
 }
 
 /* Clear the history. */
@@ -378,6 +557,76 @@ grid_clear_history(struct grid *gd)
 	    sizeof *gd->linedata);
 }
 
+/*
+ * Free the oldest history lines until at least size bytes of memory have been
+ * freed or the history is empty. Returns the number of bytes freed.
+ */
+unsigned long long
+grid_trim_history_bytes(struct grid *gd, unsigned long long size)
+{
+	unsigned long long	 before = grid_history_bytes(gd), freed = 0;
+	struct grid_line	*gl;
+	u_int			 ny;
+
+	for (ny = 0; ny < gd->hsize && freed < size; ny++) {
+		gl = &gd->linedata[ny];
+		if (gl->flags & GRID_LINE_COLD)
+			freed += sizeof *gl;
+		else
+			freed += grid_history_line_size(gl);
+	}
+	if (ny == 0)
+		return (0);
+
+	grid_trim_history(gd, ny);
+
+	gd->hsize -= ny;
+	if (gd->hscrolled > gd->hsize)
+		gd->hscrolled = gd->hsize;
+	return (before - grid_history_bytes(gd));
+}
+
+/* Move lines from the top of the screen into the history. */
+void
+grid_add_history(struct grid *gd, u_int ny)
+{
+	grid_history_add(gd, gd->hsize, ny);
+	gd->hscrolled += ny;
+	gd->hsize += ny;
+}
+
+/* Move lines from the end of the history back onto the screen. */
+void
+grid_remove_history(struct grid *gd, u_int ny)
+{
+	gd->hscrolled -= ny;
+	gd->hsize -= ny;
+	grid_history_remove(gd, gd->hsize, ny);
+	grid_history_thaw(gd, gd->hsize, ny);
+}
+
+/* Get the memory used by the history, not counting cold lines. */
+unsigned long long
+grid_history_bytes(struct grid *gd)
+{
+	unsigned long long	cold = grid_cold_bytes(gd);
+
+	if (cold > gd->hbytes)
+		return (0);
+	return (gd->hbytes - cold);
+}
+
+/* Get the memory used by the history of all grids. */
+unsigned long long
+grid_history_total_bytes(void)
+{
+	unsigned long long	cold = grid_cold_total_bytes();
+
+	if (cold > grid_history_total)
+		return (0);
+	return (grid_history_total - cold);
+}
+
 /* Scroll a region up, moving the top line into the history. */
 void
 grid_scroll_history_region(struct grid *gd, u_int upper, u_int lower, u_int bg)
@@ -407,8 +656,12 @@ grid_scroll_history_region(struct grid *gd, u_int upper, u_int lower, u_int bg)
 	grid_empty_line(gd, lower, bg);
 
 	/* Move the history offset down over the line. */
+	grid_history_add(gd, gd->hsize, 1);
 	gd->hscrolled++;
 	gd->hsize++;
+
+	if (gd->cold != NULL)
+		grid_cold_scrolled(gd);
 }
 
 /* Expand line to fit to cell. */
@@ -419,8 +672,12 @@ grid_expand_line(struct grid *gd, u_int py, u_int sx, u_int bg)
 	u_int			 xx;
 
 	gl = &gd->linedata[py];
+	if (gl->flags & GRID_LINE_COLD)
+		grid_cold_thaw(gd, gl);
 	if (sx <= gl->cellsize)
 		return;
+	if (py < gd->hsize)
+		grid_history_remove(gd, py, 1);
 
 	if (sx < gd->sx / 4)
 		sx = gd->sx / 4;
@@ -433,6 +690,9 @@ grid_expand_line(struct grid *gd, u_int py, u_int sx, u_int bg)
 	for (xx = gl->cellsize; xx < sx; xx++)
 		grid_clear_cell(gd, xx, py, bg);
 	gl->cellsize = sx;
+
+	if (py < gd->hsize)
+		grid_history_add(gd, py, 1);
 }
 
 /* Empty a line and set background colour if needed. */
@@ -513,33 +773,106 @@ grid_set_cell(struct grid *gd, u_int px, u_int py, const struct grid_cell *gc)
 		grid_store_cell(gce, gc, gc->data.data[0]);
 }
 
-/* Set cells at relative position. */
+/*
+ * Set a run of cells at relative position, all with the attributes and colours
+ * of gc. The characters are given as UTF-8 in s. If widths is NULL, each byte
+ * is a character of width one; otherwise widths gives the width of each
+ * character at the offset of its first byte and wide characters are followed
+ * by padding cells. The line and its extended cells are grown once for the
+ * whole run.
+ */
 void
 grid_set_cells(struct grid *gd, u_int px, u_int py, const struct grid_cell *gc,
-    const char *s, size_t slen)
+    const char *s, size_t slen, const u_char *widths)
 {
 	struct grid_line	*gl;
 	struct grid_cell_entry	*gce;
 	struct grid_cell	*gcp;
-	u_int			 i;
+	const u_char		*cp = (const u_char *)s;
+	u_int			 i, n, xx, width, size, need, at;
+	int			 extended, flags;
 
 	if (grid_check_y(gd, __func__, py) != 0)
 		return;
 
-	grid_expand_line(gd, py, px + slen, 8);
+	/* Work out the number of cells. */
+	if (widths == NULL)
+		n = slen;
+	else {
+		n = 0;
+		for (i = 0; i < slen; i += utf8_size(cp[i]))
+			n += widths[i];
+	}
+	grid_expand_line(gd, py, px + n, 8);
 
 	gl = &gd->linedata[py];
-	if (px + slen > gl->cellused)
-		gl->cellused = px + slen;
-
-	for (i = 0; i < slen; i++) {
-		gce = &gl->celldata[px + i];
-		if (grid_need_extended_cell(gce, gc)) {
-			gcp = grid_extended_cell(gl, gce, gc);
-			utf8_set(&gcp->data, s[i]);
-		} else
-			grid_store_cell(gce, gc, s[i]);
+	if (px + n > gl->cellused)
+		gl->cellused = px + n;
+
+	/*
+	 * Count the extended cells needed that the line doesn't already have
+	 * and grow the extended data once.
+	 */
+	extended = (gc->attr > 0xff ||
+	    (gc->fg & COLOUR_FLAG_RGB) ||
+	    (gc->bg & COLOUR_FLAG_RGB) ||
+	    gc->us != 0);
+	need = 0;
+	xx = px;
+	for (i = 0; i < slen; i += size) {
+		size = (widths == NULL ? 1 : utf8_size(cp[i]));
+		width = (widths == NULL ? 1 : widths[i]);
+		if (extended || size != 1 || width != 1) {
+			for (n = 0; n < width; n++) {
+				gce = &gl->celldata[xx + n];
+				if (~gce->flags & GRID_FLAG_EXTENDED)
+					need++;
+			}
+		}
+		xx += width;
+	}
+	if (need != 0)
+		grid_reserve_extended(gl, gl->extdsize + need);
+
+	/* Store the cells. */
+	at = gl->extdsize;
+	gl->extdsize += need;
+	flags = (gc->flags & ~GRID_FLAG_CLEARED);
+	xx = px;
+	for (i = 0; i < slen; i += size) {
+		size = (widths == NULL ? 1 : utf8_size(cp[i]));
+		width = (widths == NULL ? 1 : widths[i]);
+
+		gce = &gl->celldata[xx];
+		if (!extended && size == 1 && width == 1 &&
+		    (~gce->flags & GRID_FLAG_EXTENDED)) {
+			grid_store_cell(gce, gc, cp[i]);
+			xx++;
+			continue;
+		}
+
+		if (~gce->flags & GRID_FLAG_EXTENDED)
+			gce->offset = at++;
+		gce->flags = (flags|GRID_FLAG_EXTENDED);
+		gcp = &gl->extddata[gce->offset];
+		memcpy(gcp, gc, sizeof *gcp);
+		gcp->flags = flags;
+		memcpy(gcp->data.data, cp + i, size);
+		gcp->data.size = gcp->data.have = size;
+		gcp->data.width = width;
+		xx++;
+
+		for (n = 1; n < width; n++, xx++) {
+			gce = &gl->celldata[xx];
+			if (~gce->flags & GRID_FLAG_EXTENDED)
+				gce->offset = at++;
+			gce->flags = (GRID_FLAG_PADDING|GRID_FLAG_EXTENDED);
+			gcp = &gl->extddata[gce->offset];
+			memcpy(gcp, &grid_padding_cell, sizeof *gcp);
+		}
 	}
+	if (need != 0)
+		gl->flags |= GRID_LINE_EXTENDED;
 }
 
 /* Clear area. */
@@ -980,6 +1313,7 @@ grid_duplicate_lines(struct grid *dst, u_int dy, struct grid *src, u_int sy,
 		dstl = &dst->linedata[dy];
 
 		memcpy(dstl, srcl, sizeof *dstl);
+		dstl->flags &= ~(GRID_LINE_COLD|GRID_LINE_ROUNDED);
 		if (srcl->cellsize != 0) {
 			dstl->celldata = xreallocarray(NULL,
 			    srcl->cellsize, sizeof *dstl->celldata);
@@ -1131,8 +1465,7 @@ grid_reflow_join(struct grid *target, struct grid *gd, u_int sx, u_int yy,
 
 	/* Remove the lines that were completely consumed. */
 	for (i = yy + 1; i < yy + 1 + lines; i++) {
-		free(gd->linedata[i].celldata);
-		free(gd->linedata[i].extddata);
+		grid_free_line(gd, i);
 		grid_reflow_dead(&gd->linedata[i]);
 	}
 
@@ -1154,6 +1487,10 @@ grid_reflow_split(struct grid *target, struct grid *gd, u_int sx, u_int yy,
 	u_int			 used = gl->cellused;
 	int			 flags = gl->flags;
 
+	/* The line is about to be shortened, so it can no longer be cold. */
+	if (gl->flags & GRID_LINE_COLD)
+		grid_cold_thaw(gd, gl);
+
 	/* How many lines do we need to insert? We know we need at least two. */
 	if (~gl->flags & GRID_LINE_EXTENDED)
 		lines = 1 + (gl->cellused - 1) / sx;
@@ -1225,6 +1562,7 @@ grid_reflow(struct grid *gd, u_int sx)
 	 * line data and may not be fully valid.
 	 */
 	target = grid_create(gd->sx, 0, 0);
+	target->cold = gd->cold;
 
 	/*
 	 * Loop over each source line.
@@ -1297,6 +1635,14 @@ grid_reflow(struct grid *gd, u_int sx)
 	free(gd->linedata);
 	gd->linedata = target->linedata;
 	free(target);
+	grid_history_recount(gd);
+
+	/*
+	 * Lines now on the screen may not stay cold. Lines that were split or
+	 * joined are no longer cold, so freeze the history again.
+	 */
+	grid_history_thaw(gd, gd->hsize, gd->sy);
+	grid_cold_sweep(gd);
 }
 
 /* Convert to position based on wrapped lines. */
@@ -1376,3 +1722,198 @@ grid_line_length(struct grid *gd, u_int py)
 	}
 	return (px);
 }
+
+/* Get the number of lines to save, leaving out empty lines at the end. */
+static u_int
+grid_save_lines(struct grid *gd)
+{
+	struct grid_line	*gl;
+	u_int			 yy, lines = 0, last = 0;
+
+	for (yy = 0; yy < gd->hsize + gd->sy; yy++) {
+		gl = &gd->linedata[yy];
+		if (gl->flags & GRID_LINE_DEAD)
+			continue;
+		lines++;
+		if (gl->cellsize != 0)
+			last = lines;
+	}
+	return (last);
+}
+
+/* Write the history and visible lines of a grid to a file. */
+int
+grid_save(struct grid *gd, FILE *f)
+{
+	struct grid_save_header	 hdr;
+	struct grid_save_line	 sl;
+	struct grid_line	*gl;
+	u_int			 yy, n;
+
+	memset(&hdr, 0, sizeof hdr);
+	memcpy(hdr.magic, GRID_SAVE_MAGIC, sizeof hdr.magic);
+	hdr.version = GRID_SAVE_VERSION;
+	hdr.entry_size = sizeof *gl->celldata;
+	hdr.cell_size = sizeof *gl->extddata;
+	hdr.sx = gd->sx;
+	hdr.lines = grid_save_lines(gd);
+	if (fwrite(&hdr, sizeof hdr, 1, f) != 1)
+		return (-1);
+
+	n = 0;
+	for (yy = 0; n < hdr.lines; yy++) {
+		gl = &gd->linedata[yy];
+		if (gl->flags & GRID_LINE_DEAD)
+			continue;
+		n++;
+
+		sl.cellused = gl->cellused;
+		sl.cellsize = gl->cellsize;
+		sl.extdsize = gl->extdsize;
+		sl.flags = gl->flags & ~(GRID_LINE_COLD|GRID_LINE_ROUNDED);
+		if (fwrite(&sl, sizeof sl, 1, f) != 1)
+			return (-1);
+		if (fwrite(gl->celldata, sizeof *gl->celldata, gl->cellsize,
+		    f) != gl->cellsize)
+			return (-1);
+		if (fwrite(gl->extddata, sizeof *gl->extddata, gl->extdsize,
+		    f) != gl->extdsize)
+			return (-1);
+	}
+	return (0);
+}
+
+/* Read one saved line. */
+static int
+grid_load_line(struct grid_line *gl, const u_char **pp, const u_char *end)
+{
+	const u_char		*p = *pp;
+	struct grid_save_line	 sl;
+	struct grid_cell_entry	*gce;
+	struct grid_cell	*gc;
+	size_t			 size;
+	u_int			 xx;
+
+	if ((size_t)(end - p) < sizeof sl)
+		return (-1);
+	memcpy(&sl, p, sizeof sl);
+	p += sizeof sl;
+
+	if (sl.cellused > sl.cellsize ||
+	    sl.cellsize > (size_t)(end - p) / sizeof *gl->celldata)
+		return (-1);
+	size = sl.cellsize * sizeof *gl->celldata;
+	if (size != 0) {
+		gl->celldata = xmalloc(size);
+		memcpy(gl->celldata, p, size);
+		p += size;
+	}
+	gl->cellused = sl.cellused;
+	gl->cellsize = sl.cellsize;
+
+	if (sl.extdsize > (size_t)(end - p) / sizeof *gl->extddata)
+		return (-1);
+	size = sl.extdsize * sizeof *gl->extddata;
+	if (size != 0) {
+		gl->extddata = xmalloc(size);
+		memcpy(gl->extddata, p, size);
+		p += size;
+	}
+	gl->extdsize = sl.extdsize;
+
+	gl->flags = sl.flags & (GRID_LINE_WRAPPED|GRID_LINE_EXTENDED);
+	for (xx = 0; xx < gl->cellsize; xx++) {
+		gce = &gl->celldata[xx];
+		if (~gce->flags & GRID_FLAG_EXTENDED)
+			continue;
+		if (gce->offset >= gl->extdsize)
+			return (-1);
+		gc = &gl->extddata[gce->offset];
+		if (gc->data.size > UTF8_SIZE || gc->data.have > UTF8_SIZE)
+			return (-1);
+	}
+
+	*pp = p;
+	return (0);
+}
+
+/*
+ * Add lines saved with grid_save to the top of the history, as many as fit in
+ * the history limit. Lines are reflowed if the saved width is different.
+ */
+int
+grid_load(struct grid *gd, const void *buf, size_t len, char **cause)
+{
+	const u_char		*p = buf, *end = p + len;
+	struct grid_save_header	 hdr;
+	struct grid		*saved;
+	u_int			 yy, n, first, room;
+
+	if (len < sizeof hdr) {
+		*cause = xstrdup("not a saved history file");
+		return (-1);
+	}
+	memcpy(&hdr, p, sizeof hdr);
+	p += sizeof hdr;
+	if (memcmp(hdr.magic, GRID_SAVE_MAGIC, sizeof hdr.magic) != 0 ||
+	    hdr.version != GRID_SAVE_VERSION) {
+		*cause = xstrdup("not a saved history file");
+		return (-1);
+	}
+	if (hdr.entry_size != sizeof (struct grid_cell_entry) ||
+	    hdr.cell_size != sizeof (struct grid_cell)) {
+		*cause = xstrdup("saved history is from an incompatible build");
+		return (-1);
+	}
+	if (hdr.sx == 0 ||
+	    hdr.lines > (len - sizeof hdr) / sizeof (struct grid_save_line)) {
+		*cause = xstrdup("saved history is corrupt");
+		return (-1);
+	}
+	if (hdr.lines == 0)
+		return (0);
+
+	saved = grid_create(hdr.sx, hdr.lines, 0);
+	for (yy = 0; yy < hdr.lines; yy++) {
+		if (grid_load_line(&saved->linedata[yy], &p, end) != 0) {
+			grid_destroy(saved);
+			*cause = xstrdup("saved history is corrupt");
+			return (-1);
+		}
+	}
+	if (saved->sx != gd->sx)
+		grid_reflow(saved, gd->sx);
+
+	/* Reflowing may leave empty lines at the end, so remove them. */
+	n = saved->hsize + saved->sy;
+	while (n > 0 && saved->linedata[n - 1].cellsize == 0)
+		grid_free_line(saved, --n);
+
+	/* Drop the oldest lines if there is not room for them all. */
+	if (gd->hsize < gd->hlimit)
+		room = gd->hlimit - gd->hsize;
+	else
+		room = 0;
+	if (n > room)
+		first = n - room;
+	else
+		first = 0;
+	grid_free_lines(saved, 0, first);
+	n -= first;
+
+	yy = gd->hsize + gd->sy;
+	gd->linedata = xreallocarray(gd->linedata, yy + n,
+	    sizeof *gd->linedata);
+	memmove(&gd->linedata[n], &gd->linedata[0], yy * sizeof *gd->linedata);
+	memcpy(&gd->linedata[0], &saved->linedata[first],
+	    n * sizeof *gd->linedata);
+	gd->hsize += n;
+	gd->hscrolled += n;
+	grid_history_add(gd, 0, n);
+	grid_cold_sweep(gd);
+
+	grid_history_total -= saved->hbytes;
+	free(saved->linedata);
+	free(saved);
+	return (0);
+}
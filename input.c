@@ -105,6 +105,10 @@ struct input_ctx {
 	struct utf8_data	utf8data;
 	int			utf8started;
 
+	const u_char	       *parse_buf;
+	size_t			parse_len;
+	size_t			parse_off;
+
 	int			ch;
 	int			last;
 
@@ -889,7 +893,6 @@ input_parse_buffer(struct window_pane *wp, u_char *buf, size_t len)
 	struct input_ctx		*ictx = wp->ictx;
 	struct screen_write_ctx		*sctx = &ictx->ctx;
 	const struct input_transition	*itr;
-	size_t				 off = 0;
 
 	if (len == 0)
 		return;
@@ -911,9 +914,15 @@ input_parse_buffer(struct window_pane *wp, u_char *buf, size_t len)
 	log_debug("%s: %%%u %s, %zu bytes: %.*s", __func__, wp->id,
 	    ictx->state->name, len, (int)len, buf);
 
-	/* Parse the input. */
-	while (off < len) {
-		ictx->ch = buf[off++];
+	/*
+	 * Parse the input. The offset is kept in the context so handlers can
+	 * consume more than one byte.
+	 */
+	ictx->parse_buf = buf;
+	ictx->parse_len = len;
+	ictx->parse_off = 0;
+	while (ictx->parse_off < len) {
+		ictx->ch = buf[ictx->parse_off++];
 
 		/* Find the transition. */
 		itr = ictx->state->transitions;
@@ -928,13 +937,14 @@ input_parse_buffer(struct window_pane *wp, u_char *buf, size_t len)
 		}
 
 		/*
-		 * Any state except print stops the current collection. This is
-		 * an optimization to avoid checking if the attributes have
-		 * changed for every character. It will stop unnecessarily for
-		 * sequences that don't make a terminal change, but they should
-		 * be the minority.
+		 * Any state except print (of ASCII or UTF-8) stops the current
+		 * collection. This is an optimization to avoid checking if the
+		 * attributes have changed for every character. It will stop
+		 * unnecessarily for sequences that don't make a terminal
+		 * change, but they should be the minority.
 		 */
-		if (itr->handler != input_print)
+		if (itr->handler != input_print &&
+		    itr->handler != input_top_bit_set)
 			screen_write_collect_end(sctx);
 
 		/*
@@ -2290,26 +2300,39 @@ input_top_bit_set(struct input_ctx *ictx)
 {
 	struct screen_write_ctx	*sctx = &ictx->ctx;
 	struct utf8_data	*ud = &ictx->utf8data;
+	size_t			 used;
 
 	ictx->last = -1;
 
+	/*
+	 * If the whole character is in the buffer, decode and measure it at
+	 * once. Otherwise collect it a byte at a time.
+	 */
 	if (!ictx->utf8started) {
-		if (utf8_open(ud, ictx->ch) != UTF8_MORE)
+		switch (utf8_decode(ud, ictx->parse_buf + ictx->parse_off - 1,
+		    ictx->parse_len - ictx->parse_off + 1, &used)) {
+		case UTF8_MORE:
+			ictx->utf8started = 1;
 			return (0);
-		ictx->utf8started = 1;
-		return (0);
-	}
-
-	switch (utf8_append(ud, ictx->ch)) {
-	case UTF8_MORE:
-		return (0);
-	case UTF8_ERROR:
+		case UTF8_ERROR:
+			ictx->parse_off += used - 1;
+			return (0);
+		case UTF8_DONE:
+			ictx->parse_off += used - 1;
+			break;
+		}
+	} else {
+		switch (utf8_append(ud, ictx->ch)) {
+		case UTF8_MORE:
+			return (0);
+		case UTF8_ERROR:
+			ictx->utf8started = 0;
+			return (0);
+		case UTF8_DONE:
+			break;
+		}
 		ictx->utf8started = 0;
-		return (0);
-	case UTF8_DONE:
-		break;
 	}
-	ictx->utf8started = 0;
 
 	log_debug("%s %hhu '%*s' (width %hhu)", __func__, ud->size,
 	    (int)ud->size, ud->data, ud->width);
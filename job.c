@@ -64,6 +64,140 @@ struct job {
 /* All jobs list. */
 static LIST_HEAD(joblist, job) all_jobs = LIST_HEAD_INITIALIZER(all_jobs);
 
+#if defined(HAVE_VFORK) && defined(HAVE_CLOSEFROM)
+/*
+ * Start the process with vfork(2). Unlike fork(2), this does not copy the
+ * server's page tables, which takes longer the more history is held. The
+ * child shares the server's memory until it execs, so everything that
+ * allocates is done first and the child makes only system calls.
+ */
+static pid_t
+job_vfork(const char *cmd, const char *cwd, struct environ *env, int infd,
+    int outfd, sigset_t *oldset)
+{
+	static const int	 signals[] = { SIGINT, SIGPIPE, SIGTSTP, SIGHUP,
+				     SIGCHLD, SIGCONT, SIGTERM, SIGUSR1,
+				     SIGUSR2, SIGWINCH };
+	struct environ_entry	*envent;
+	struct sigaction	 sa;
+	const char		*home;
+	char			*argv[4], **envp;
+	u_int			 i, n;
+	int			 nullfd, fds[3];
+	pid_t			 pid;
+
+	nullfd = open(_PATH_DEVNULL, O_RDWR, 0);
+	if (nullfd == -1)
+		return (-1);
+	fds[0] = (infd == -1 ? nullfd : infd);
+	fds[1] = (outfd == -1 ? nullfd : outfd);
+	fds[2] = nullfd;
+
+	n = 0;
+	envp = NULL;
+	if (env != NULL) {
+		envp = xcalloc(1, sizeof *envp);
+		envent = environ_first(env);
+		for (; envent != NULL; envent = environ_next(envent)) {
+			if (envent->value == NULL || *envent->name == '\0')
+				continue;
+			envp = xreallocarray(envp, n + 2, sizeof *envp);
+			xasprintf(&envp[n++], "%s=%s", envent->name,
+			    envent->value);
+			envp[n] = NULL;
+		}
+	}
+	argv[0] = xstrdup("sh");
+	argv[1] = xstrdup("-c");
+	argv[2] = xstrdup(cmd);
+	argv[3] = NULL;
+	home = find_home();
+
+	memset(&sa, 0, sizeof sa);
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = SA_RESTART;
+	sa.sa_handler = SIG_DFL;
+
+	if ((pid = vfork()) == 0) {
+		for (i = 0; i < nitems(signals); i++)
+			sigaction(signals[i], &sa, NULL);
+		sigprocmask(SIG_SETMASK, oldset, NULL);
+
+		if (cwd != NULL && chdir(cwd) != 0) {
+			if (home == NULL || chdir(home) != 0)
+				chdir("/");
+		}
+
+		for (i = 0; i < nitems(fds); i++) {
+			if (dup2(fds[i], i) == -1)
+				_exit(1);
+		}
+		closefrom(STDERR_FILENO + 1);
+
+		execve(_PATH_BSHELL, argv, envp != NULL ? envp : environ);
+		_exit(1);
+	}
+
+	close(nullfd);
+	for (i = 0; i < 3; i++)
+		free(argv[i]);
+	for (i = 0; i < n; i++)
+		free(envp[i]);
+	free(envp);
+	return (pid);
+}
+#endif
+
+/*
+ * Start a process running a command with the shell, with vfork(2) where
+ * possible. Standard input and output are infd and outfd, or /dev/null if they
+ * are -1, and standard error is /dev/null. The working directory is changed to
+ * cwd (or home or / if that fails) unless it is NULL, and the environment is
+ * env or the server's if it is NULL. Must be called with signals blocked;
+ * oldset is the mask to restore in the child. Returns the process ID or -1.
+ */
+pid_t
+job_fork(const char *cmd, const char *cwd, struct environ *env, int infd,
+    int outfd, sigset_t *oldset)
+{
+#if defined(HAVE_VFORK) && defined(HAVE_CLOSEFROM)
+	return (job_vfork(cmd, cwd, env, infd, outfd, oldset));
+#else
+	const char	*home;
+	int		 nullfd;
+	pid_t		 pid;
+
+	if ((pid = fork()) != 0)
+		return (pid);
+
+	proc_clear_signals(server_proc, 1);
+	sigprocmask(SIG_SETMASK, oldset, NULL);
+
+	if (cwd != NULL && chdir(cwd) != 0) {
+		if ((home = find_home()) == NULL || chdir(home) != 0)
+			chdir("/");
+	}
+	if (env != NULL)
+		environ_push(env);
+
+	nullfd = open(_PATH_DEVNULL, O_RDWR, 0);
+	if (nullfd == -1)
+		_exit(1);
+	if (infd == -1)
+		infd = nullfd;
+	if (outfd == -1)
+		outfd = nullfd;
+	if (dup2(infd, STDIN_FILENO) == -1 ||
+	    dup2(outfd, STDOUT_FILENO) == -1 ||
+	    dup2(nullfd, STDERR_FILENO) == -1)
+		_exit(1);
+	closefrom(STDERR_FILENO + 1);
+
+	execl(_PATH_BSHELL, "sh", "-c", cmd, (char *) NULL);
+	_exit(1);
+#endif
+}
+
 /* Start a job running, if it isn't already. */
 struct job *
 job_run(const char *cmd, struct session *s, const char *cwd,
@@ -73,8 +207,7 @@ job_run(const char *cmd, struct session *s, const char *cwd,
 	struct job	*job;
 	struct environ	*env;
 	pid_t		 pid;
-	int		 nullfd, out[2];
-	const char	*home;
+	int		 out[2];
 	sigset_t	 set, oldset;
 
 	if (socketpair(AF_UNIX, SOCK_STREAM, PF_UNSPEC, out) != 0)
@@ -87,47 +220,18 @@ job_run(const char *cmd, struct session *s, const char *cwd,
 	 */
 	env = environ_for_session(s, !cfg_finished);
 
+	/* Without a working directory, start in home. */
+	if (cwd == NULL && (cwd = find_home()) == NULL)
+		cwd = "/";
+
 	sigfillset(&set);
 	sigprocmask(SIG_BLOCK, &set, &oldset);
-	switch (pid = fork()) {
-	case -1:
+	if ((pid = job_fork(cmd, cwd, env, out[1], out[1], &oldset)) == -1) {
 		sigprocmask(SIG_SETMASK, &oldset, NULL);
 		environ_free(env);
 		close(out[0]);
 		close(out[1]);
 		return (NULL);
-	case 0:
-		proc_clear_signals(server_proc, 1);
-		sigprocmask(SIG_SETMASK, &oldset, NULL);
-
-		if (cwd == NULL || chdir(cwd) != 0) {
-			if ((home = find_home()) == NULL || chdir(home) != 0)
-				chdir("/");
-		}
-
-		environ_push(env);
-		environ_free(env);
-
-		if (dup2(out[1], STDIN_FILENO) == -1)
-			fatal("dup2 failed");
-		if (dup2(out[1], STDOUT_FILENO) == -1)
-			fatal("dup2 failed");
-		if (out[1] != STDIN_FILENO && out[1] != STDOUT_FILENO)
-			close(out[1]);
-		close(out[0]);
-
-		nullfd = open(_PATH_DEVNULL, O_RDWR, 0);
-		if (nullfd == -1)
-			fatal("open failed");
-		if (dup2(nullfd, STDERR_FILENO) == -1)
-			fatal("dup2 failed");
-		if (nullfd != STDERR_FILENO)
-			close(nullfd);
-
-		closefrom(STDERR_FILENO + 1);
-
-		execl(_PATH_BSHELL, "sh", "-c", cmd, (char *) NULL);
-		fatal("execl failed");
 	}
 
 	sigprocmask(SIG_SETMASK, &oldset, NULL);
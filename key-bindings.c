@@ -69,9 +69,270 @@
 	" '#{?pane_marked,Unmark,Mark}' 'm' {select-pane -m}" \
 	" '#{?window_zoomed_flag,Unzoom,Zoom}' 'z' {resize-pane -Z}"
 
+/*
+ * Default key bindings. These are added directly to the key tables when the
+ * server starts; the commands are not parsed until a binding is first used
+ * or listed.
+ */
+struct key_bindings_default {
+	const char	*table;
+	const char	*key;
+	int		 repeat;
+	const char	*command;
+};
+static const struct key_bindings_default key_bindings_defaults[] = {
+	{ "prefix", "C-b", 0, "send-prefix" },
+	{ "prefix", "C-o", 0, "rotate-window" },
+	{ "prefix", "C-z", 0, "suspend-client" },
+	{ "prefix", "Space", 0, "next-layout" },
+	{ "prefix", "!", 0, "break-pane" },
+	{ "prefix", "\"", 0, "split-window" },
+	{ "prefix", "#", 0, "list-buffers" },
+	{ "prefix", "$", 0, "command-prompt -I'#S' \"rename-session -- '%%'\"" },
+	{ "prefix", "%", 0, "split-window -h" },
+	{ "prefix", "&", 0, "confirm-before -p\"kill-window #W? (y/n)\" kill-window" },
+	{ "prefix", "'", 0, "command-prompt -pindex \"select-window -t ':%%'\"" },
+	{ "prefix", "(", 0, "switch-client -p" },
+	{ "prefix", ")", 0, "switch-client -n" },
+	{ "prefix", ",", 0, "command-prompt -I'#W' \"rename-window -- '%%'\"" },
+	{ "prefix", "-", 0, "delete-buffer" },
+	{ "prefix", ".", 0, "command-prompt \"move-window -t '%%'\"" },
+	{ "prefix", "0", 0, "select-window -t:=0" },
+	{ "prefix", "1", 0, "select-window -t:=1" },
+	{ "prefix", "2", 0, "select-window -t:=2" },
+	{ "prefix", "3", 0, "select-window -t:=3" },
+	{ "prefix", "4", 0, "select-window -t:=4" },
+	{ "prefix", "5", 0, "select-window -t:=5" },
+	{ "prefix", "6", 0, "select-window -t:=6" },
+	{ "prefix", "7", 0, "select-window -t:=7" },
+	{ "prefix", "8", 0, "select-window -t:=8" },
+	{ "prefix", "9", 0, "select-window -t:=9" },
+	{ "prefix", ":", 0, "command-prompt" },
+	{ "prefix", ";", 0, "last-pane" },
+	{ "prefix", "=", 0, "choose-buffer -Z" },
+	{ "prefix", "?", 0, "list-keys" },
+	{ "prefix", "D", 0, "choose-client -Z" },
+	{ "prefix", "E", 0, "select-layout -E" },
+	{ "prefix", "L", 0, "switch-client -l" },
+	{ "prefix", "M", 0, "select-pane -M" },
+	{ "prefix", "[", 0, "copy-mode" },
+	{ "prefix", "]", 0, "paste-buffer" },
+	{ "prefix", "c", 0, "new-window" },
+	{ "prefix", "d", 0, "detach-client" },
+	{ "prefix", "f", 0, "command-prompt \"find-window -Z -- '%%'\"" },
+	{ "prefix", "i", 0, "display-message" },
+	{ "prefix", "l", 0, "last-window" },
+	{ "prefix", "m", 0, "select-pane -m" },
+	{ "prefix", "n", 0, "next-window" },
+	{ "prefix", "o", 0, "select-pane -t:.+" },
+	{ "prefix", "p", 0, "previous-window" },
+	{ "prefix", "q", 0, "display-panes" },
+	{ "prefix", "r", 0, "refresh-client" },
+	{ "prefix", "s", 0, "choose-tree -Zs" },
+	{ "prefix", "t", 0, "clock-mode" },
+	{ "prefix", "w", 0, "choose-tree -Zw" },
+	{ "prefix", "x", 0, "confirm-before -p\"kill-pane #P? (y/n)\" kill-pane" },
+	{ "prefix", "z", 0, "resize-pane -Z" },
+	{ "prefix", "{", 0, "swap-pane -U" },
+	{ "prefix", "}", 0, "swap-pane -D" },
+	{ "prefix", "~", 0, "show-messages" },
+	{ "prefix", "PPage", 0, "copy-mode -u" },
+	{ "prefix", "Up", 1, "select-pane -U" },
+	{ "prefix", "Down", 1, "select-pane -D" },
+	{ "prefix", "Left", 1, "select-pane -L" },
+	{ "prefix", "Right", 1, "select-pane -R" },
+	{ "prefix", "M-1", 0, "select-layout even-horizontal" },
+	{ "prefix", "M-2", 0, "select-layout even-vertical" },
+	{ "prefix", "M-3", 0, "select-layout main-horizontal" },
+	{ "prefix", "M-4", 0, "select-layout main-vertical" },
+	{ "prefix", "M-5", 0, "select-layout tiled" },
+	{ "prefix", "M-n", 0, "next-window -a" },
+	{ "prefix", "M-o", 0, "rotate-window -D" },
+	{ "prefix", "M-p", 0, "previous-window -a" },
+	{ "prefix", "S-Up", 1, "refresh-client -U 10" },
+	{ "prefix", "S-Down", 1, "refresh-client -D 10" },
+	{ "prefix", "S-Left", 1, "refresh-client -L 10" },
+	{ "prefix", "S-Right", 1, "refresh-client -R 10" },
+	{ "prefix", "DC", 1, "refresh-client -c" },
+	{ "prefix", "M-Up", 1, "resize-pane -U 5" },
+	{ "prefix", "M-Down", 1, "resize-pane -D 5" },
+	{ "prefix", "M-Left", 1, "resize-pane -L 5" },
+	{ "prefix", "M-Right", 1, "resize-pane -R 5" },
+	{ "prefix", "C-Up", 1, "resize-pane -U" },
+	{ "prefix", "C-Down", 1, "resize-pane -D" },
+	{ "prefix", "C-Left", 1, "resize-pane -L" },
+	{ "prefix", "C-Right", 1, "resize-pane -R" },
+
+	{ "root", "MouseDown1Pane", 0, "select-pane -t=; send-keys -M" },
+	{ "root", "MouseDrag1Border", 0, "resize-pane -M" },
+	{ "root", "MouseDown1Status", 0, "select-window -t=" },
+	{ "root", "WheelDownStatus", 0, "next-window" },
+	{ "root", "WheelUpStatus", 0, "previous-window" },
+	{ "root", "MouseDrag1Pane", 0, "if -Ft= '#{mouse_any_flag}' 'if -Ft= \"#{pane_in_mode}\" \"copy-mode -M\" \"send-keys -M\"' 'copy-mode -M'" },
+	{ "root", "WheelUpPane", 0, "if -Ft= '#{mouse_any_flag}' 'send-keys -M' 'if -Ft= \"#{pane_in_mode}\" \"send-keys -M\" \"copy-mode -et=\"'" },
+
+	{ "root", "MouseDown3StatusRight", 0, "display-menu -t= -xM -yS -T \"#[align=centre]#{client_name}\" " DEFAULT_CLIENT_MENU },
+	{ "root", "MouseDown3StatusLeft", 0, "display-menu -t= -xM -yS -T \"#[align=centre]#{session_name}\" " DEFAULT_SESSION_MENU },
+	{ "root", "MouseDown3Status", 0, "display-menu -t= -xW -yS -T \"#[align=centre]#{window_index}:#{window_name}\" " DEFAULT_WINDOW_MENU },
+	{ "prefix", "<", 0, "display-menu -xW -yS -T \"#[align=centre]#{window_index}:#{window_name}\" " DEFAULT_WINDOW_MENU },
+	{ "root", "MouseDown3Pane", 0, "if -Ft= '#{||:#{mouse_any_flag},#{pane_in_mode}}' 'select-pane -t=; send-keys -M' {display-menu -t= -xM -yM -T \"#[align=centre]#{pane_index} (#{pane_id})\" " DEFAULT_PANE_MENU "}" },
+	{ "root", "M-MouseDown3Pane", 0, "display-menu -t= -xM -yM -T \"#[align=centre]#{pane_index} (#{pane_id})\" " DEFAULT_PANE_MENU },
+	{ "prefix", ">", 0, "display-menu -xP -yP -T \"#[align=centre]#{pane_index} (#{pane_id})\" " DEFAULT_PANE_MENU },
+
+	{ "copy-mode", "C-Space", 0, "send -X begin-selection" },
+	{ "copy-mode", "C-a", 0, "send -X start-of-line" },
+	{ "copy-mode", "C-c", 0, "send -X cancel" },
+	{ "copy-mode", "C-e", 0, "send -X end-of-line" },
+	{ "copy-mode", "C-f", 0, "send -X cursor-right" },
+	{ "copy-mode", "C-b", 0, "send -X cursor-left" },
+	{ "copy-mode", "C-g", 0, "send -X clear-selection" },
+	{ "copy-mode", "C-k", 0, "send -X copy-end-of-line" },
+	{ "copy-mode", "C-n", 0, "send -X cursor-down" },
+	{ "copy-mode", "C-p", 0, "send -X cursor-up" },
+	{ "copy-mode", "C-r", 0, "command-prompt -ip'(search up)' -I'#{pane_search_string}' 'send -X search-backward-incremental \"%%%\"'" },
+	{ "copy-mode", "C-s", 0, "command-prompt -ip'(search down)' -I'#{pane_search_string}' 'send -X search-forward-incremental \"%%%\"'" },
+	{ "copy-mode", "C-v", 0, "send -X page-down" },
+	{ "copy-mode", "C-w", 0, "send -X copy-selection-and-cancel" },
+	{ "copy-mode", "Escape", 0, "send -X cancel" },
+	{ "copy-mode", "Space", 0, "send -X page-down" },
+	{ "copy-mode", ",", 0, "send -X jump-reverse" },
+	{ "copy-mode", ";", 0, "send -X jump-again" },
+	{ "copy-mode", "F", 0, "command-prompt -1p'(jump backward)' 'send -X jump-backward \"%%%\"'" },
+	{ "copy-mode", "N", 0, "send -X search-reverse" },
+	{ "copy-mode", "R", 0, "send -X rectangle-toggle" },
+	{ "copy-mode", "T", 0, "command-prompt -1p'(jump to backward)' 'send -X jump-to-backward \"%%%\"'" },
+	{ "copy-mode", "f", 0, "command-prompt -1p'(jump forward)' 'send -X jump-forward \"%%%\"'" },
+	{ "copy-mode", "g", 0, "command-prompt -p'(goto line)' 'send -X goto-line \"%%%\"'" },
+	{ "copy-mode", "n", 0, "send -X search-again" },
+	{ "copy-mode", "q", 0, "send -X cancel" },
+	{ "copy-mode", "t", 0, "command-prompt -1p'(jump to forward)' 'send -X jump-to-forward \"%%%\"'" },
+	{ "copy-mode", "Home", 0, "send -X start-of-line" },
+	{ "copy-mode", "End", 0, "send -X end-of-line" },
+	{ "copy-mode", "MouseDown1Pane", 0, "select-pane" },
+	{ "copy-mode", "MouseDrag1Pane", 0, "select-pane; send -X begin-selection" },
+	{ "copy-mode", "MouseDragEnd1Pane", 0, "send -X copy-selection-and-cancel" },
+	{ "copy-mode", "WheelUpPane", 0, "select-pane; send -N5 -X scroll-up" },
+	{ "copy-mode", "WheelDownPane", 0, "select-pane; send -N5 -X scroll-down" },
+	{ "copy-mode", "DoubleClick1Pane", 0, "select-pane; send -X select-word" },
+	{ "copy-mode", "TripleClick1Pane", 0, "select-pane; send -X select-line" },
+	{ "copy-mode", "NPage", 0, "send -X page-down" },
+	{ "copy-mode", "PPage", 0, "send -X page-up" },
+	{ "copy-mode", "Up", 0, "send -X cursor-up" },
+	{ "copy-mode", "Down", 0, "send -X cursor-down" },
+	{ "copy-mode", "Left", 0, "send -X cursor-left" },
+	{ "copy-mode", "Right", 0, "send -X cursor-right" },
+	{ "copy-mode", "M-1", 0, "command-prompt -Np'(repeat)' -I1 'send -N \"%%%\"'" },
+	{ "copy-mode", "M-2", 0, "command-prompt -Np'(repeat)' -I2 'send -N \"%%%\"'" },
+	{ "copy-mode", "M-3", 0, "command-prompt -Np'(repeat)' -I3 'send -N \"%%%\"'" },
+	{ "copy-mode", "M-4", 0, "command-prompt -Np'(repeat)' -I4 'send -N \"%%%\"'" },
+	{ "copy-mode", "M-5", 0, "command-prompt -Np'(repeat)' -I5 'send -N \"%%%\"'" },
+	{ "copy-mode", "M-6", 0, "command-prompt -Np'(repeat)' -I6 'send -N \"%%%\"'" },
+	{ "copy-mode", "M-7", 0, "command-prompt -Np'(repeat)' -I7 'send -N \"%%%\"'" },
+	{ "copy-mode", "M-8", 0, "command-prompt -Np'(repeat)' -I8 'send -N \"%%%\"'" },
+	{ "copy-mode", "M-9", 0, "command-prompt -Np'(repeat)' -I9 'send -N \"%%%\"'" },
+	{ "copy-mode", "M-<", 0, "send -X history-top" },
+	{ "copy-mode", "M->", 0, "send -X history-bottom" },
+	{ "copy-mode", "M-R", 0, "send -X top-line" },
+	{ "copy-mode", "M-b", 0, "send -X previous-word" },
+	{ "copy-mode", "C-M-b", 0, "send -X previous-matching-bracket" },
+	{ "copy-mode", "M-f", 0, "send -X next-word-end" },
+	{ "copy-mode", "C-M-f", 0, "send -X next-matching-bracket" },
+	{ "copy-mode", "M-m", 0, "send -X back-to-indentation" },
+	{ "copy-mode", "M-r", 0, "send -X middle-line" },
+	{ "copy-mode", "M-v", 0, "send -X page-up" },
+	{ "copy-mode", "M-w", 0, "send -X copy-selection-and-cancel" },
+	{ "copy-mode", "M-{", 0, "send -X previous-paragraph" },
+	{ "copy-mode", "M-}", 0, "send -X next-paragraph" },
+	{ "copy-mode", "M-Up", 0, "send -X halfpage-up" },
+	{ "copy-mode", "M-Down", 0, "send -X halfpage-down" },
+	{ "copy-mode", "C-Up", 0, "send -X scroll-up" },
+	{ "copy-mode", "C-Down", 0, "send -X scroll-down" },
+
+	{ "copy-mode-vi", "C-c", 0, "send -X cancel" },
+	{ "copy-mode-vi", "C-d", 0, "send -X halfpage-down" },
+	{ "copy-mode-vi", "C-e", 0, "send -X scroll-down" },
+	{ "copy-mode-vi", "C-b", 0, "send -X page-up" },
+	{ "copy-mode-vi", "C-f", 0, "send -X page-down" },
+	{ "copy-mode-vi", "C-h", 0, "send -X cursor-left" },
+	{ "copy-mode-vi", "C-j", 0, "send -X copy-selection-and-cancel" },
+	{ "copy-mode-vi", "Enter", 0, "send -X copy-selection-and-cancel" },
+	{ "copy-mode-vi", "C-u", 0, "send -X halfpage-up" },
+	{ "copy-mode-vi", "C-v", 0, "send -X rectangle-toggle" },
+	{ "copy-mode-vi", "C-y", 0, "send -X scroll-up" },
+	{ "copy-mode-vi", "Escape", 0, "send -X clear-selection" },
+	{ "copy-mode-vi", "Space", 0, "send -X begin-selection" },
+	{ "copy-mode-vi", "$", 0, "send -X end-of-line" },
+	{ "copy-mode-vi", ",", 0, "send -X jump-reverse" },
+	{ "copy-mode-vi", "/", 0, "command-prompt -p'(search down)' 'send -X search-forward \"%%%\"'" },
+	{ "copy-mode-vi", "0", 0, "send -X start-of-line" },
+	{ "copy-mode-vi", "1", 0, "command-prompt -Np'(repeat)' -I1 'send -N \"%%%\"'" },
+	{ "copy-mode-vi", "2", 0, "command-prompt -Np'(repeat)' -I2 'send -N \"%%%\"'" },
+	{ "copy-mode-vi", "3", 0, "command-prompt -Np'(repeat)' -I3 'send -N \"%%%\"'" },
+	{ "copy-mode-vi", "4", 0, "command-prompt -Np'(repeat)' -I4 'send -N \"%%%\"'" },
+	{ "copy-mode-vi", "5", 0, "command-prompt -Np'(repeat)' -I5 'send -N \"%%%\"'" },
+	{ "copy-mode-vi", "6", 0, "command-prompt -Np'(repeat)' -I6 'send -N \"%%%\"'" },
+	{ "copy-mode-vi", "7", 0, "command-prompt -Np'(repeat)' -I7 'send -N \"%%%\"'" },
+	{ "copy-mode-vi", "8", 0, "command-prompt -Np'(repeat)' -I8 'send -N \"%%%\"'" },
+	{ "copy-mode-vi", "9", 0, "command-prompt -Np'(repeat)' -I9 'send -N \"%%%\"'" },
+	{ "copy-mode-vi", ":", 0, "command-prompt -p'(goto line)' 'send -X goto-line \"%%%\"'" },
+	{ "copy-mode-vi", ";", 0, "send -X jump-again" },
+	{ "copy-mode-vi", "?", 0, "command-prompt -p'(search up)' 'send -X search-backward \"%%%\"'" },
+	{ "copy-mode-vi", "A", 0, "send -X append-selection-and-cancel" },
+	{ "copy-mode-vi", "B", 0, "send -X previous-space" },
+	{ "copy-mode-vi", "D", 0, "send -X copy-end-of-line" },
+	{ "copy-mode-vi", "E", 0, "send -X next-space-end" },
+	{ "copy-mode-vi", "F", 0, "command-prompt -1p'(jump backward)' 'send -X jump-backward \"%%%\"'" },
+	{ "copy-mode-vi", "G", 0, "send -X history-bottom" },
+	{ "copy-mode-vi", "H", 0, "send -X top-line" },
+	{ "copy-mode-vi", "J", 0, "send -X scroll-down" },
+	{ "copy-mode-vi", "K", 0, "send -X scroll-up" },
+	{ "copy-mode-vi", "L", 0, "send -X bottom-line" },
+	{ "copy-mode-vi", "M", 0, "send -X middle-line" },
+	{ "copy-mode-vi", "N", 0, "send -X search-reverse" },
+	{ "copy-mode-vi", "T", 0, "command-prompt -1p'(jump to backward)' 'send -X jump-to-backward \"%%%\"'" },
+	{ "copy-mode-vi", "V", 0, "send -X select-line" },
+	{ "copy-mode-vi", "W", 0, "send -X next-space" },
+	{ "copy-mode-vi", "^", 0, "send -X back-to-indentation" },
+	{ "copy-mode-vi", "b", 0, "send -X previous-word" },
+	{ "copy-mode-vi", "e", 0, "send -X next-word-end" },
+	{ "copy-mode-vi", "f", 0, "command-prompt -1p'(jump forward)' 'send -X jump-forward \"%%%\"'" },
+	{ "copy-mode-vi", "g", 0, "send -X history-top" },
+	{ "copy-mode-vi", "h", 0, "send -X cursor-left" },
+	{ "copy-mode-vi", "j", 0, "send -X cursor-down" },
+	{ "copy-mode-vi", "k", 0, "send -X cursor-up" },
+	{ "copy-mode-vi", "l", 0, "send -X cursor-right" },
+	{ "copy-mode-vi", "n", 0, "send -X search-again" },
+	{ "copy-mode-vi", "o", 0, "send -X other-end" },
+	{ "copy-mode-vi", "q", 0, "send -X cancel" },
+	{ "copy-mode-vi", "t", 0, "command-prompt -1p'(jump to forward)' 'send -X jump-to-forward \"%%%\"'" },
+	{ "copy-mode-vi", "v", 0, "send -X rectangle-toggle" },
+	{ "copy-mode-vi", "w", 0, "send -X next-word" },
+	{ "copy-mode-vi", "{", 0, "send -X previous-paragraph" },
+	{ "copy-mode-vi", "}", 0, "send -X next-paragraph" },
+	{ "copy-mode-vi", "%", 0, "send -X next-matching-bracket" },
+	{ "copy-mode-vi", "MouseDown1Pane", 0, "select-pane" },
+	{ "copy-mode-vi", "MouseDrag1Pane", 0, "select-pane; send -X begin-selection" },
+	{ "copy-mode-vi", "MouseDragEnd1Pane", 0, "send -X copy-selection-and-cancel" },
+	{ "copy-mode-vi", "WheelUpPane", 0, "select-pane; send -N5 -X scroll-up" },
+	{ "copy-mode-vi", "WheelDownPane", 0, "select-pane; send -N5 -X scroll-down" },
+	{ "copy-mode-vi", "DoubleClick1Pane", 0, "select-pane; send -X select-word" },
+	{ "copy-mode-vi", "TripleClick1Pane", 0, "select-pane; send -X select-line" },
+	{ "copy-mode-vi", "BSpace", 0, "send -X cursor-left" },
+	{ "copy-mode-vi", "NPage", 0, "send -X page-down" },
+	{ "copy-mode-vi", "PPage", 0, "send -X page-up" },
+	{ "copy-mode-vi", "Up", 0, "send -X cursor-up" },
+	{ "copy-mode-vi", "Down", 0, "send -X cursor-down" },
+	{ "copy-mode-vi", "Left", 0, "send -X cursor-left" },
+	{ "copy-mode-vi", "Right", 0, "send -X cursor-right" },
+	{ "copy-mode-vi", "C-Up", 0, "send -X scroll-up" },
+	{ "copy-mode-vi", "C-Down", 0, "send -X scroll-down" },
+};
+
 static int key_bindings_cmp(struct key_binding *, struct key_binding *);
 RB_GENERATE_STATIC(key_bindings, key_binding, entry, key_bindings_cmp);
 static int key_table_cmp(struct key_table *, struct key_table *);
+static void key_bindings_free(struct key_binding *);
+static struct key_binding *key_bindings_insert(const char *, key_code, int);
 RB_GENERATE_STATIC(key_tables, key_table, entry, key_table_cmp);
 static struct key_tables key_tables = RB_INITIALIZER(&key_tables);
 
@@ -123,6 +384,14 @@ key_bindings_next_table(struct key_table *table)
 	return (RB_NEXT(key_tables, &key_tables, table));
 }
 
+static void
+key_bindings_free(struct key_binding *bd)
+{
+	if (bd->cmdlist != NULL)
+		cmd_list_free(bd->cmdlist);
+	free(bd);
+}
+
 void
 key_bindings_unref_table(struct key_table *table)
 {
@@ -134,14 +403,28 @@ key_bindings_unref_table(struct key_table *table)
 
 	RB_FOREACH_SAFE(bd, key_bindings, &table->key_bindings, bd1) {
 		RB_REMOVE(key_bindings, &table->key_bindings, bd);
-		cmd_list_free(bd->cmdlist);
-		free(bd);
+		key_bindings_free(bd);
 	}
 
 	free((void *)table->name);
 	free(table);
 }
 
+/* Get the commands for a binding, parsing them if not done already. */
+struct cmd_list *
+key_bindings_get_cmdlist(struct key_binding *bd)
+{
+	struct cmd_parse_result	*pr;
+
+	if (bd->cmdlist == NULL) {
+		pr = cmd_parse_from_string(bd->cmdstring, NULL);
+		if (pr->status != CMD_PARSE_SUCCESS)
+			fatalx("bad default key command: %s", bd->cmdstring);
+		bd->cmdlist = pr->cmdlist;
+	}
+	return (bd->cmdlist);
+}
+
 struct key_binding *
 key_bindings_get(struct key_table *table, key_code key)
 {
@@ -163,9 +446,8 @@ key_bindings_next(__unused struct key_table *table, struct key_binding *bd)
 	return (RB_NEXT(key_bindings, &table->key_bindings, bd));
 }
 
-void
-key_bindings_add(const char *name, key_code key, int repeat,
-    struct cmd_list *cmdlist)
+static struct key_binding *
+key_bindings_insert(const char *name, key_code key, int repeat)
 {
 	struct key_table	*table;
 	struct key_binding	 bd_find, *bd;
@@ -176,8 +458,7 @@ key_bindings_add(const char *name, key_code key, int repeat,
 	bd = RB_FIND(key_bindings, &table->key_bindings, &bd_find);
 	if (bd != NULL) {
 		RB_REMOVE(key_bindings, &table->key_bindings, bd);
-		cmd_list_free(bd->cmdlist);
-		free(bd);
+		key_bindings_free(bd);
 	}
 
 	bd = xcalloc(1, sizeof *bd);
@@ -186,6 +467,16 @@ key_bindings_add(const char *name, key_code key, int repeat,
 
 	if (repeat)
 		bd->flags |= KEY_BINDING_REPEAT;
+	return (bd);
+}
+
+void
+key_bindings_add(const char *name, key_code key, int repeat,
+    struct cmd_list *cmdlist)
+{
+	struct key_binding	*bd;
+
+	bd = key_bindings_insert(name, key, repeat);
 	bd->cmdlist = cmdlist;
 }
 
@@ -205,8 +496,7 @@ key_bindings_remove(const char *name, key_code key)
 		return;
 
 	RB_REMOVE(key_bindings, &table->key_bindings, bd);
-	cmd_list_free(bd->cmdlist);
-	free(bd);
+	key_bindings_free(bd);
 
 	if (RB_EMPTY(&table->key_bindings)) {
 		RB_REMOVE(key_tables, &key_tables, table);
@@ -234,262 +524,19 @@ key_bindings_remove_table(const char *name)
 void
 key_bindings_init(void)
 {
-	static const char *defaults[] = {
-		"bind C-b send-prefix",
-		"bind C-o rotate-window",
-		"bind C-z suspend-client",
-		"bind Space next-layout",
-		"bind ! break-pane",
-		"bind '\"' split-window",
-		"bind '#' list-buffers",
-		"bind '$' command-prompt -I'#S' \"rename-session -- '%%'\"",
-		"bind % split-window -h",
-		"bind & confirm-before -p\"kill-window #W? (y/n)\" kill-window",
-		"bind \"'\" command-prompt -pindex \"select-window -t ':%%'\"",
-		"bind ( switch-client -p",
-		"bind ) switch-client -n",
-		"bind , command-prompt -I'#W' \"rename-window -- '%%'\"",
-		"bind - delete-buffer",
-		"bind . command-prompt \"move-window -t '%%'\"",
-		"bind 0 select-window -t:=0",
-		"bind 1 select-window -t:=1",
-		"bind 2 select-window -t:=2",
-		"bind 3 select-window -t:=3",
-		"bind 4 select-window -t:=4",
-		"bind 5 select-window -t:=5",
-		"bind 6 select-window -t:=6",
-		"bind 7 select-window -t:=7",
-		"bind 8 select-window -t:=8",
-		"bind 9 select-window -t:=9",
-		"bind : command-prompt",
-		"bind \\; last-pane",
-		"bind = choose-buffer -Z",
-		"bind ? list-keys",
-		"bind D choose-client -Z",
-		"bind E select-layout -E",
-		"bind L switch-client -l",
-		"bind M select-pane -M",
-		"bind [ copy-mode",
-		"bind ] paste-buffer",
-		"bind c new-window",
-		"bind d detach-client",
-		"bind f command-prompt \"find-window -Z -- '%%'\"",
-		"bind i display-message",
-		"bind l last-window",
-		"bind m select-pane -m",
-		"bind n next-window",
-		"bind o select-pane -t:.+",
-		"bind p previous-window",
-		"bind q display-panes",
-		"bind r refresh-client",
-		"bind s choose-tree -Zs",
-		"bind t clock-mode",
-		"bind w choose-tree -Zw",
-		"bind x confirm-before -p\"kill-pane #P? (y/n)\" kill-pane",
-		"bind z resize-pane -Z",
-		"bind '{' swap-pane -U",
-		"bind '}' swap-pane -D",
-		"bind '~' show-messages",
-		"bind PPage copy-mode -u",
-		"bind -r Up select-pane -U",
-		"bind -r Down select-pane -D",
-		"bind -r Left select-pane -L",
-		"bind -r Right select-pane -R",
-		"bind M-1 select-layout even-horizontal",
-		"bind M-2 select-layout even-vertical",
-		"bind M-3 select-layout main-horizontal",
-		"bind M-4 select-layout main-vertical",
-		"bind M-5 select-layout tiled",
-		"bind M-n next-window -a",
-		"bind M-o rotate-window -D",
-		"bind M-p previous-window -a",
-		"bind -r S-Up refresh-client -U 10",
-		"bind -r S-Down refresh-client -D 10",
-		"bind -r S-Left refresh-client -L 10",
-		"bind -r S-Right refresh-client -R 10",
-		"bind -r DC refresh-client -c",
-		"bind -r M-Up resize-pane -U 5",
-		"bind -r M-Down resize-pane -D 5",
-		"bind -r M-Left resize-pane -L 5",
-		"bind -r M-Right resize-pane -R 5",
-		"bind -r C-Up resize-pane -U",
-		"bind -r C-Down resize-pane -D",
-		"bind -r C-Left resize-pane -L",
-		"bind -r C-Right resize-pane -R",
-
-		"bind -n MouseDown1Pane select-pane -t=\\; send-keys -M",
-		"bind -n MouseDrag1Border resize-pane -M",
-		"bind -n MouseDown1Status select-window -t=",
-		"bind -n WheelDownStatus next-window",
-		"bind -n WheelUpStatus previous-window",
-		"bind -n MouseDrag1Pane if -Ft= '#{mouse_any_flag}' 'if -Ft= \"#{pane_in_mode}\" \"copy-mode -M\" \"send-keys -M\"' 'copy-mode -M'",
-		"bind -n WheelUpPane if -Ft= '#{mouse_any_flag}' 'send-keys -M' 'if -Ft= \"#{pane_in_mode}\" \"send-keys -M\" \"copy-mode -et=\"'",
-
-		"bind -n MouseDown3StatusRight display-menu -t= -xM -yS -T \"#[align=centre]#{client_name}\" " DEFAULT_CLIENT_MENU,
-		"bind -n MouseDown3StatusLeft display-menu -t= -xM -yS -T \"#[align=centre]#{session_name}\" " DEFAULT_SESSION_MENU,
-		"bind -n MouseDown3Status display-menu -t= -xW -yS -T \"#[align=centre]#{window_index}:#{window_name}\" " DEFAULT_WINDOW_MENU,
-		"bind < display-menu -xW -yS -T \"#[align=centre]#{window_index}:#{window_name}\" " DEFAULT_WINDOW_MENU,
-		"bind -n MouseDown3Pane if -Ft= '#{||:#{mouse_any_flag},#{pane_in_mode}}' 'select-pane -t=; send-keys -M' {display-menu -t= -xM -yM -T \"#[align=centre]#{pane_index} (#{pane_id})\" " DEFAULT_PANE_MENU "}",
-		"bind -n M-MouseDown3Pane display-menu -t= -xM -yM -T \"#[align=centre]#{pane_index} (#{pane_id})\" " DEFAULT_PANE_MENU,
-		"bind > display-menu -xP -yP -T \"#[align=centre]#{pane_index} (#{pane_id})\" " DEFAULT_PANE_MENU,
-
-		"bind -Tcopy-mode C-Space send -X begin-selection",
-		"bind -Tcopy-mode C-a send -X start-of-line",
-		"bind -Tcopy-mode C-c send -X cancel",
-		"bind -Tcopy-mode C-e send -X end-of-line",
-		"bind -Tcopy-mode C-f send -X cursor-right",
-		"bind -Tcopy-mode C-b send -X cursor-left",
-		"bind -Tcopy-mode C-g send -X clear-selection",
-		"bind -Tcopy-mode C-k send -X copy-end-of-line",
-		"bind -Tcopy-mode C-n send -X cursor-down",
-		"bind -Tcopy-mode C-p send -X cursor-up",
-		"bind -Tcopy-mode C-r command-prompt -ip'(search up)' -I'#{pane_search_string}' 'send -X search-backward-incremental \"%%%\"'",
-		"bind -Tcopy-mode C-s command-prompt -ip'(search down)' -I'#{pane_search_string}' 'send -X search-forward-incremental \"%%%\"'",
-		"bind -Tcopy-mode C-v send -X page-down",
-		"bind -Tcopy-mode C-w send -X copy-selection-and-cancel",
-		"bind -Tcopy-mode Escape send -X cancel",
-		"bind -Tcopy-mode Space send -X page-down",
-		"bind -Tcopy-mode , send -X jump-reverse",
-		"bind -Tcopy-mode \\; send -X jump-again",
-		"bind -Tcopy-mode F command-prompt -1p'(jump backward)' 'send -X jump-backward \"%%%\"'",
-		"bind -Tcopy-mode N send -X search-reverse",
-		"bind -Tcopy-mode R send -X rectangle-toggle",
-		"bind -Tcopy-mode T command-prompt -1p'(jump to backward)' 'send -X jump-to-backward \"%%%\"'",
-		"bind -Tcopy-mode f command-prompt -1p'(jump forward)' 'send -X jump-forward \"%%%\"'",
-		"bind -Tcopy-mode g command-prompt -p'(goto line)' 'send -X goto-line \"%%%\"'",
-		"bind -Tcopy-mode n send -X search-again",
-		"bind -Tcopy-mode q send -X cancel",
-		"bind -Tcopy-mode t command-prompt -1p'(jump to forward)' 'send -X jump-to-forward \"%%%\"'",
-		"bind -Tcopy-mode Home send -X start-of-line",
-		"bind -Tcopy-mode End send -X end-of-line",
-		"bind -Tcopy-mode MouseDown1Pane select-pane",
-		"bind -Tcopy-mode MouseDrag1Pane select-pane\\; send -X begin-selection",
-		"bind -Tcopy-mode MouseDragEnd1Pane send -X copy-selection-and-cancel",
-		"bind -Tcopy-mode WheelUpPane select-pane\\; send -N5 -X scroll-up",
-		"bind -Tcopy-mode WheelDownPane select-pane\\; send -N5 -X scroll-down",
-		"bind -Tcopy-mode DoubleClick1Pane select-pane\\; send -X select-word",
-		"bind -Tcopy-mode TripleClick1Pane select-pane\\; send -X select-line",
-		"bind -Tcopy-mode NPage send -X page-down",
-		"bind -Tcopy-mode PPage send -X page-up",
-		"bind -Tcopy-mode Up send -X cursor-up",
-		"bind -Tcopy-mode Down send -X cursor-down",
-		"bind -Tcopy-mode Left send -X cursor-left",
-		"bind -Tcopy-mode Right send -X cursor-right",
-		"bind -Tcopy-mode M-1 command-prompt -Np'(repeat)' -I1 'send -N \"%%%\"'",
-		"bind -Tcopy-mode M-2 command-prompt -Np'(repeat)' -I2 'send -N \"%%%\"'",
-		"bind -Tcopy-mode M-3 command-prompt -Np'(repeat)' -I3 'send -N \"%%%\"'",
-		"bind -Tcopy-mode M-4 command-prompt -Np'(repeat)' -I4 'send -N \"%%%\"'",
-		"bind -Tcopy-mode M-5 command-prompt -Np'(repeat)' -I5 'send -N \"%%%\"'",
-		"bind -Tcopy-mode M-6 command-prompt -Np'(repeat)' -I6 'send -N \"%%%\"'",
-		"bind -Tcopy-mode M-7 command-prompt -Np'(repeat)' -I7 'send -N \"%%%\"'",
-		"bind -Tcopy-mode M-8 command-prompt -Np'(repeat)' -I8 'send -N \"%%%\"'",
-		"bind -Tcopy-mode M-9 command-prompt -Np'(repeat)' -I9 'send -N \"%%%\"'",
-		"bind -Tcopy-mode M-< send -X history-top",
-		"bind -Tcopy-mode M-> send -X history-bottom",
-		"bind -Tcopy-mode M-R send -X top-line",
-		"bind -Tcopy-mode M-b send -X previous-word",
-		"bind -Tcopy-mode C-M-b send -X previous-matching-bracket",
-		"bind -Tcopy-mode M-f send -X next-word-end",
-		"bind -Tcopy-mode C-M-f send -X next-matching-bracket",
-		"bind -Tcopy-mode M-m send -X back-to-indentation",
-		"bind -Tcopy-mode M-r send -X middle-line",
-		"bind -Tcopy-mode M-v send -X page-up",
-		"bind -Tcopy-mode M-w send -X copy-selection-and-cancel",
-		"bind -Tcopy-mode 'M-{' send -X previous-paragraph",
-		"bind -Tcopy-mode 'M-}' send -X next-paragraph",
-		"bind -Tcopy-mode M-Up send -X halfpage-up",
-		"bind -Tcopy-mode M-Down send -X halfpage-down",
-		"bind -Tcopy-mode C-Up send -X scroll-up",
-		"bind -Tcopy-mode C-Down send -X scroll-down",
-
-		"bind -Tcopy-mode-vi C-c send -X cancel",
-		"bind -Tcopy-mode-vi C-d send -X halfpage-down",
-		"bind -Tcopy-mode-vi C-e send -X scroll-down",
-		"bind -Tcopy-mode-vi C-b send -X page-up",
-		"bind -Tcopy-mode-vi C-f send -X page-down",
-		"bind -Tcopy-mode-vi C-h send -X cursor-left",
-		"bind -Tcopy-mode-vi C-j send -X copy-selection-and-cancel",
-		"bind -Tcopy-mode-vi Enter send -X copy-selection-and-cancel",
-		"bind -Tcopy-mode-vi C-u send -X halfpage-up",
-		"bind -Tcopy-mode-vi C-v send -X rectangle-toggle",
-		"bind -Tcopy-mode-vi C-y send -X scroll-up",
-		"bind -Tcopy-mode-vi Escape send -X clear-selection",
-		"bind -Tcopy-mode-vi Space send -X begin-selection",
-		"bind -Tcopy-mode-vi '$' send -X end-of-line",
-		"bind -Tcopy-mode-vi , send -X jump-reverse",
-		"bind -Tcopy-mode-vi / command-prompt -p'(search down)' 'send -X search-forward \"%%%\"'",
-		"bind -Tcopy-mode-vi 0 send -X start-of-line",
-		"bind -Tcopy-mode-vi 1 command-prompt -Np'(repeat)' -I1 'send -N \"%%%\"'",
-		"bind -Tcopy-mode-vi 2 command-prompt -Np'(repeat)' -I2 'send -N \"%%%\"'",
-		"bind -Tcopy-mode-vi 3 command-prompt -Np'(repeat)' -I3 'send -N \"%%%\"'",
-		"bind -Tcopy-mode-vi 4 command-prompt -Np'(repeat)' -I4 'send -N \"%%%\"'",
-		"bind -Tcopy-mode-vi 5 command-prompt -Np'(repeat)' -I5 'send -N \"%%%\"'",
-		"bind -Tcopy-mode-vi 6 command-prompt -Np'(repeat)' -I6 'send -N \"%%%\"'",
-		"bind -Tcopy-mode-vi 7 command-prompt -Np'(repeat)' -I7 'send -N \"%%%\"'",
-		"bind -Tcopy-mode-vi 8 command-prompt -Np'(repeat)' -I8 'send -N \"%%%\"'",
-		"bind -Tcopy-mode-vi 9 command-prompt -Np'(repeat)' -I9 'send -N \"%%%\"'",
-		"bind -Tcopy-mode-vi : command-prompt -p'(goto line)' 'send -X goto-line \"%%%\"'",
-		"bind -Tcopy-mode-vi \\; send -X jump-again",
-		"bind -Tcopy-mode-vi ? command-prompt -p'(search up)' 'send -X search-backward \"%%%\"'",
-		"bind -Tcopy-mode-vi A send -X append-selection-and-cancel",
-		"bind -Tcopy-mode-vi B send -X previous-space",
-		"bind -Tcopy-mode-vi D send -X copy-end-of-line",
-		"bind -Tcopy-mode-vi E send -X next-space-end",
-		"bind -Tcopy-mode-vi F command-prompt -1p'(jump backward)' 'send -X jump-backward \"%%%\"'",
-		"bind -Tcopy-mode-vi G send -X history-bottom",
-		"bind -Tcopy-mode-vi H send -X top-line",
-		"bind -Tcopy-mode-vi J send -X scroll-down",
-		"bind -Tcopy-mode-vi K send -X scroll-up",
-		"bind -Tcopy-mode-vi L send -X bottom-line",
-		"bind -Tcopy-mode-vi M send -X middle-line",
-		"bind -Tcopy-mode-vi N send -X search-reverse",
-		"bind -Tcopy-mode-vi T command-prompt -1p'(jump to backward)' 'send -X jump-to-backward \"%%%\"'",
-		"bind -Tcopy-mode-vi V send -X select-line",
-		"bind -Tcopy-mode-vi W send -X next-space",
-		"bind -Tcopy-mode-vi ^ send -X back-to-indentation",
-		"bind -Tcopy-mode-vi b send -X previous-word",
-		"bind -Tcopy-mode-vi e send -X next-word-end",
-		"bind -Tcopy-mode-vi f command-prompt -1p'(jump forward)' 'send -X jump-forward \"%%%\"'",
-		"bind -Tcopy-mode-vi g send -X history-top",
-		"bind -Tcopy-mode-vi h send -X cursor-left",
-		"bind -Tcopy-mode-vi j send -X cursor-down",
-		"bind -Tcopy-mode-vi k send -X cursor-up",
-		"bind -Tcopy-mode-vi l send -X cursor-right",
-		"bind -Tcopy-mode-vi n send -X search-again",
-		"bind -Tcopy-mode-vi o send -X other-end",
-		"bind -Tcopy-mode-vi q send -X cancel",
-		"bind -Tcopy-mode-vi t command-prompt -1p'(jump to forward)' 'send -X jump-to-forward \"%%%\"'",
-		"bind -Tcopy-mode-vi v send -X rectangle-toggle",
-		"bind -Tcopy-mode-vi w send -X next-word",
-		"bind -Tcopy-mode-vi '{' send -X previous-paragraph",
-		"bind -Tcopy-mode-vi '}' send -X next-paragraph",
-		"bind -Tcopy-mode-vi % send -X next-matching-bracket",
-		"bind -Tcopy-mode-vi MouseDown1Pane select-pane",
-		"bind -Tcopy-mode-vi MouseDrag1Pane select-pane\\; send -X begin-selection",
-		"bind -Tcopy-mode-vi MouseDragEnd1Pane send -X copy-selection-and-cancel",
-		"bind -Tcopy-mode-vi WheelUpPane select-pane\\; send -N5 -X scroll-up",
-		"bind -Tcopy-mode-vi WheelDownPane select-pane\\; send -N5 -X scroll-down",
-		"bind -Tcopy-mode-vi DoubleClick1Pane select-pane\\; send -X select-word",
-		"bind -Tcopy-mode-vi TripleClick1Pane select-pane\\; send -X select-line",
-		"bind -Tcopy-mode-vi BSpace send -X cursor-left",
-		"bind -Tcopy-mode-vi NPage send -X page-down",
-		"bind -Tcopy-mode-vi PPage send -X page-up",
-		"bind -Tcopy-mode-vi Up send -X cursor-up",
-		"bind -Tcopy-mode-vi Down send -X cursor-down",
-		"bind -Tcopy-mode-vi Left send -X cursor-left",
-		"bind -Tcopy-mode-vi Right send -X cursor-right",
-		"bind -Tcopy-mode-vi C-Up send -X scroll-up",
-		"bind -Tcopy-mode-vi C-Down send -X scroll-down",
-	};
-	u_int			 i;
-	struct cmd_parse_result	*pr;
-
-	for (i = 0; i < nitems(defaults); i++) {
-		pr = cmd_parse_from_string(defaults[i], NULL);
-		if (pr->status != CMD_PARSE_SUCCESS)
-			fatalx("bad default key: %s", defaults[i]);
-		cmdq_append(NULL, cmdq_get_command(pr->cmdlist, NULL, NULL, 0));
-		cmd_list_free(pr->cmdlist);
+	const struct key_bindings_default	*kbd;
+	struct key_binding			*bd;
+	key_code				 key;
+	u_int					 i;
+
+	for (i = 0; i < nitems(key_bindings_defaults); i++) {
+		kbd = &key_bindings_defaults[i];
+
+		key = key_string_lookup_string(kbd->key);
+		if (key == KEYC_NONE || key == KEYC_UNKNOWN)
+			fatalx("bad default key: %s", kbd->key);
+		bd = key_bindings_insert(kbd->table, key, kbd->repeat);
+		bd->cmdstring = kbd->command;
 	}
 }
 
@@ -504,19 +551,20 @@ struct cmdq_item *
 key_bindings_dispatch(struct key_binding *bd, struct cmdq_item *item,
     struct client *c, struct mouse_event *m, struct cmd_find_state *fs)
 {
+	struct cmd_list		*cmdlist = key_bindings_get_cmdlist(bd);
 	struct cmd		*cmd;
 	struct cmdq_item	*new_item;
 	int			 readonly;
 
 	readonly = 1;
-	TAILQ_FOREACH(cmd, &bd->cmdlist->list, qentry) {
+	TAILQ_FOREACH(cmd, &cmdlist->list, qentry) {
 		if (!(cmd->entry->flags & CMD_READONLY))
 			readonly = 0;
 	}
 	if (!readonly && (c->flags & CLIENT_READONLY))
 		new_item = cmdq_get_callback(key_bindings_read_only, NULL);
 	else {
-		new_item = cmdq_get_command(bd->cmdlist, fs, m, 0);
+		new_item = cmdq_get_command(cmdlist, fs, m, 0);
 		if (bd->flags & KEY_BINDING_REPEAT)
 			new_item->shared->flags |= CMDQ_SHARED_REPEAT;
 	}
@@ -292,6 +292,8 @@ layout_fix_panes(struct window *w)
 	struct layout_cell	*lc;
 	int			 status;
 
+	screen_redraw_invalidate(w);
+
 	status = options_get_number(w->options, "pane-border-status");
 	TAILQ_FOREACH(wp, &w->panes, entry) {
 		if ((lc = wp->layout_cell) == NULL)
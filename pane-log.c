@@ -0,0 +1,294 @@
+/* $OpenBSD$ */
+
+/*
+ * Copyright (c) 2026 Nicholas Marriott <nicholas.marriott@gmail.com>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF MIND, USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING
+ * OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "tmux.h"
+
+/*
+ * Pane output logging. If pane-log-file is set, output read from the pane is
+ * appended to a buffer which is written to the file when it is large enough
+ * or after a short delay, so each read does not cost a write. The file is
+ * rotated when it grows past pane-log-size or is older than
+ * pane-log-interval.
+ *
+ * Writes are blocking: O_NONBLOCK makes no difference to regular files, so
+ * the server waits for each batch to be written.
+ */
+
+/* Write when this much is buffered. */
+#define PANE_LOG_BATCH 65536
+
+/* Otherwise write after this long. */
+#define PANE_LOG_DELAY 100000
+
+struct pane_log {
+	struct window_pane	*wp;
+
+	char			*path;
+	int			 fd;
+	off_t			 size;
+	time_t			 opened;
+	u_int			 next;
+
+	struct evbuffer		*buffer;
+	struct event		 timer;
+};
+
+/* Expand pane-log-file for a pane. */
+static char *
+pane_log_expand(struct window_pane *wp, const char *template)
+{
+	struct cmd_find_state	 fs;
+	struct format_tree	*ft;
+	char			*path;
+
+	ft = format_create(NULL, NULL, FORMAT_PANE|wp->id, 0);
+	if (cmd_find_from_pane(&fs, wp, 0) == 0)
+		format_defaults(ft, NULL, fs.s, fs.wl, wp);
+	else
+		format_defaults(ft, NULL, NULL, NULL, wp);
+	path = format_expand_time(ft, template);
+	format_free(ft);
+
+	return (path);
+}
+
+/*
+ * Open the log file. It is opened nonblocking so a FIFO with no reader fails
+ * rather than waiting, but is then written blocking.
+ */
+static int
+pane_log_open_file(struct pane_log *pl)
+{
+	struct stat	sb;
+
+	pl->fd = open(pl->path, O_WRONLY|O_CREAT|O_APPEND|O_NONBLOCK, 0644);
+	if (pl->fd == -1) {
+		log_debug("%%%u log %s: %s", pl->wp->id, pl->path,
+		    strerror(errno));
+		return (-1);
+	}
+	setblocking(pl->fd, 1);
+	if (fstat(pl->fd, &sb) == 0)
+		pl->size = sb.st_size;
+	else
+		pl->size = 0;
+	pl->opened = time(NULL);
+
+	log_debug("%%%u log %s opened (%lld bytes)", pl->wp->id, pl->path,
+	    (long long)pl->size);
+	return (0);
+}
+
+/*
+ * Close the log file and open a new one. If the file name has not changed,
+ * the old file is renamed to name.1, name.2 and so on. The first rotation
+ * looks for the first unused suffix and later ones carry on from there.
+ */
+static void
+pane_log_rotate(struct pane_log *pl)
+{
+	struct window_pane	*wp = pl->wp;
+	struct stat		 sb;
+	const char		*template;
+	char			*path, *old;
+	u_int			 n;
+
+	template = options_get_string(wp->options, "pane-log-file");
+	path = pane_log_expand(wp, template);
+
+	close(pl->fd);
+	pl->fd = -1;
+
+	if (strcmp(path, pl->path) == 0) {
+		if (pl->next == 0) {
+			for (n = 1; n != 0; n++) {
+				xasprintf(&old, "%s.%u", pl->path, n);
+				if (lstat(old, &sb) != 0) {
+					free(old);
+					break;
+				}
+				free(old);
+			}
+			pl->next = n;
+		}
+		if (pl->next != 0) {
+			xasprintf(&old, "%s.%u", pl->path, pl->next++);
+			if (rename(pl->path, old) != 0) {
+				log_debug("%%%u log %s: %s", wp->id, old,
+				    strerror(errno));
+			}
+			free(old);
+		}
+	} else
+		pl->next = 0;
+	free(pl->path);
+	pl->path = path;
+
+	pane_log_open_file(pl);
+}
+
+/* Write buffered output to the log file. */
+static void
+pane_log_flush(struct pane_log *pl)
+{
+	struct window_pane	*wp = pl->wp;
+	size_t			 size;
+	long long		 limit;
+	time_t			 interval;
+	int			 n;
+
+	evtimer_del(&pl->timer);
+	if (EVBUFFER_LENGTH(pl->buffer) == 0)
+		return;
+
+	interval = options_get_number(wp->options, "pane-log-interval");
+	if (pl->fd != -1 && interval != 0 &&
+	    time(NULL) - pl->opened >= interval)
+		pane_log_rotate(pl);
+	if (pl->fd == -1) {
+		evbuffer_drain(pl->buffer, EVBUFFER_LENGTH(pl->buffer));
+		return;
+	}
+
+	while ((size = EVBUFFER_LENGTH(pl->buffer)) != 0) {
+		n = evbuffer_write(pl->buffer, pl->fd);
+		if (n == -1) {
+			if (errno == EINTR)
+				continue;
+			log_debug("%%%u log %s: %s", wp->id, pl->path,
+			    strerror(errno));
+			evbuffer_drain(pl->buffer, size);
+			break;
+		}
+		pl->size += n;
+	}
+
+	limit = options_get_number(wp->options, "pane-log-size");
+	if (limit != 0 && pl->size >= limit)
+		pane_log_rotate(pl);
+}
+
+/* Timer to write buffered output. */
+static void
+pane_log_timer(__unused int fd, __unused short events, void *data)
+{
+	pane_log_flush(data);
+}
+
+/* Start logging a pane to a file. */
+static struct pane_log *
+pane_log_open(struct window_pane *wp, char *path)
+{
+	struct pane_log	*pl;
+
+	pl = xcalloc(1, sizeof *pl);
+	pl->wp = wp;
+	pl->path = path;
+
+	if (pane_log_open_file(pl) != 0) {
+		free(pl->path);
+		free(pl);
+		return (NULL);
+	}
+
+	pl->buffer = evbuffer_new();
+	if (pl->buffer == NULL)
+		fatalx("out of memory");
+	evtimer_set(&pl->timer, pane_log_timer, pl);
+
+	return (pl);
+}
+
+/* Stop logging a pane, writing anything still buffered. */
+void
+pane_log_close(struct window_pane *wp)
+{
+	struct pane_log	*pl = wp->log;
+
+	if (pl == NULL)
+		return;
+	wp->log = NULL;
+
+	pane_log_flush(pl);
+	evtimer_del(&pl->timer);
+	if (pl->fd != -1)
+		close(pl->fd);
+	log_debug("%%%u log %s closed", wp->id, pl->path);
+
+	evbuffer_free(pl->buffer);
+	free(pl->path);
+	free(pl);
+}
+
+/* Start, stop or change a pane's log after pane-log-file may have changed. */
+void
+pane_log_update(struct window_pane *wp)
+{
+	const char	*template;
+	char		*path;
+
+	template = options_get_string(wp->options, "pane-log-file");
+	if (*template == '\0') {
+		pane_log_close(wp);
+		return;
+	}
+
+	path = pane_log_expand(wp, template);
+	if (wp->log != NULL && strcmp(path, wp->log->path) == 0) {
+		free(path);
+		return;
+	}
+	pane_log_close(wp);
+	wp->log = pane_log_open(wp, path);
+}
+
+/* Add pane output to the log. */
+void
+pane_log_write(struct window_pane *wp, const void *data, size_t size)
+{
+	struct pane_log	*pl = wp->log;
+	struct timeval	 tv = { .tv_usec = PANE_LOG_DELAY };
+
+	evbuffer_add(pl->buffer, data, size);
+	if (EVBUFFER_LENGTH(pl->buffer) >= PANE_LOG_BATCH)
+		pane_log_flush(pl);
+	else if (!evtimer_pending(&pl->timer, NULL))
+		evtimer_add(&pl->timer, &tv);
+}
+
+/* Write buffered output for all panes, used when the server exits. */
+void
+pane_log_flush_all(void)
+{
+	struct window_pane	*wp;
+
+	RB_FOREACH(wp, window_pane_tree, &all_window_panes) {
+		if (wp->log != NULL)
+			pane_log_flush(wp->log);
+	}
+}
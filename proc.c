@@ -168,6 +168,12 @@ proc_send(struct tmuxpeer *peer, enum msgtype type, int fd, const void *buf,
 	return (0);
 }
 
+u_int
+proc_queued(struct tmuxpeer *peer)
+{
+	return (peer->ibuf.w.queued);
+}
+
 struct tmuxproc *
 proc_start(const char *name)
 {
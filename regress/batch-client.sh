@@ -0,0 +1,49 @@
+#!/bin/sh
+
+# batch mode client (-B) runs commands from stdin without a session
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Ltest"
+$TMUX kill-server 2>/dev/null
+
+TMP=$(mktemp)
+trap "rm -f $TMP" 0 1 15
+
+cat <<EOF|$TMUX -f/dev/null -B >$TMP || exit 1
+new -d -sfoo
+neww -d -tfoo
+display -p -tfoo '#{session_windows}'
+nosuchcommand
+rename -tfoo bar
+ls -F '#{session_name}'
+EOF
+$TMUX has -tbar || exit 1
+sed -e 's/^%\([a-z]*\) [0-9]* [0-9]* [0-9]*$/%\1/' $TMP|cmp -s - <<EOF || exit 1
+%begin
+%end
+%begin
+%end
+%begin
+2
+%end
+%begin
+parse error: unknown command: nosuchcommand
+%error
+%begin
+%end
+%begin
+bar
+%end
+EOF
+
+echo 'ls -F "#{session_name}"'|$TMUX -B ls -F'#{session_windows}' >$TMP || exit 1
+grep -v '^%' $TMP|cmp -s - <<EOF || exit 1
+2
+bar
+EOF
+$TMUX kill-server 2>/dev/null
+
+exit 0
@@ -0,0 +1,40 @@
+#!/bin/sh
+
+# A large capture to stdout should be complete and in order, even to a slow
+# reader and with commands after it. The pane should carry on while the capture
+# is waiting for the reader.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -f/dev/null -Ltest"
+$TMUX kill-server 2>/dev/null
+
+IN=$(mktemp)
+TMP=$(mktemp)
+trap "rm -f $IN $TMP" 0 1 15
+
+seq 1 50000 >$IN
+
+$TMUX new -d -x80 -y10 \; set -g history-limit 60000 \; \
+	neww "cat $IN; $TMUX wait -S done; cat" || exit 1
+$TMUX wait done || exit 1
+
+$TMUX capturep -p -S- \; display -p end | \
+	(sleep 1; grep .) >$TMP || exit 1
+echo end >>$IN
+cmp -s $IN $TMP || exit 1
+
+$TMUX capturep -p -S- | (sleep 2; grep . | grep -v foo) >$TMP &
+sleep 0.5
+$TMUX send -t:1 foo Enter || exit 1
+sleep 0.5
+$TMUX capturep -pt:1 | grep -q foo || exit 1
+wait
+$TMUX kill-server 2>/dev/null
+
+sed '$d' $IN >$IN.1 && mv $IN.1 $IN
+cmp -s $IN $TMP || exit 1
+
+exit 0
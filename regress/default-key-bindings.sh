@@ -0,0 +1,34 @@
+#!/bin/sh
+
+# Test every default key binding parses: list-keys parses each command the
+# first time it is listed and the server exits on a bad one. The output is
+# then loaded into a second server and must list the same, except for empty
+# menu separators which are printed without quotes.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Ltest"
+$TMUX kill-server 2>/dev/null
+
+TMP=$(mktemp)
+TMP2=$(mktemp)
+trap "rm -f $TMP $TMP2" 0 1 15
+
+$TMUX -f/dev/null new -d || exit 1
+$TMUX list-keys >$TMP || exit 1
+$TMUX has || exit 1
+$TMUX kill-server 2>/dev/null
+[ -s $TMP ] || exit 1
+
+$TMUX -f/dev/null new -d \; unbind -a \; unbind -aTcopy-mode \; \
+	unbind -aTcopy-mode-vi || exit 1
+$TMUX source $TMP || exit 1
+$TMUX list-keys >$TMP2 || exit 1
+$TMUX kill-server 2>/dev/null
+tr -s ' ' <$TMP >$TMP.1 && mv $TMP.1 $TMP
+tr -s ' ' <$TMP2 >$TMP2.1 && mv $TMP2.1 $TMP2
+cmp -s $TMP $TMP2 || exit 1
+
+exit 0
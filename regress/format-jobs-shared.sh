@@ -0,0 +1,33 @@
+#!/bin/sh
+
+# A format job in the status line that doesn't use client formats should be
+# run once for all clients, not once for each.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Ltest"
+$TMUX kill-server 2>/dev/null
+
+TMP=$(mktemp)
+trap "rm -f $TMP" 0 1 15
+
+$TMUX -f/dev/null new -d -s main || exit 1
+$TMUX set -g status-interval 1 || exit 1
+$TMUX set -g status-right "#(echo x >>$TMP; echo job)" || exit 1
+$TMUX new -d -s other || exit 1
+for i in 1 2 3 4; do
+	$TMUX neww -d -t other: "TMUX= $TMUX attach -t main" || exit 1
+done
+sleep 4
+
+[ $($TMUX lsc | wc -l) -eq 4 ] || exit 1
+$TMUX capturep -p -t other:1 | tail -1 | grep -q 'job$' || exit 1
+RUNS=$($TMUX display -p '#{format_job_runs}')
+$TMUX kill-server 2>/dev/null
+
+[ $(wc -l <$TMP) -eq $RUNS ] || exit 1
+[ $RUNS -gt 0 -a $RUNS -le 6 ] || exit 1
+
+exit 0
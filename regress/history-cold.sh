@@ -0,0 +1,48 @@
+#!/bin/sh
+
+# Test history moved to the file by history-cold-limit is unchanged, including
+# after the pane is resized and lines are reflowed.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Ltest"
+$TMUX kill-server 2>/dev/null
+
+TMP=$(mktemp)
+TMP2=$(mktemp)
+trap "rm -f $TMP $TMP2" 0 1 15
+
+capture() {
+	$TMUX -f/dev/null new -d -x40 -y10 \; \
+		set -g history-limit 1000 \; \
+		set -g history-cold-limit $1 \; \
+		set -g window-size manual \; \
+		neww -d "awk 'BEGIN { for (i = 0; i < 2000; i++)
+			printf \"\033[3%dm%d\033[0m \344\275\240 %*s\n\",
+			    i % 8, i, i % 70, \"x\" }'
+			$TMUX wait -S done
+			cat" || exit 1
+	$TMUX wait done || exit 1
+	$TMUX capturep -t:1 -epS- || exit 1
+	$TMUX resizew -t:1 -x 25 || exit 1
+	$TMUX capturep -t:1 -epS- || exit 1
+	$TMUX resizew -t:1 -x 60 || exit 1
+	$TMUX capturep -t:1 -epS- || exit 1
+	$TMUX display -pt:1 '#{history_cold_bytes}' || exit 1
+	$TMUX kill-server 2>/dev/null
+}
+
+capture 0 >$TMP
+capture 10 >$TMP2
+
+# Nothing is cold without the limit and something is with it.
+[ "$(tail -1 $TMP)" = 0 ] || exit 1
+[ "$(tail -1 $TMP2)" -gt 0 ] || exit 1
+
+sed '$d' $TMP >$TMP.1 && mv $TMP.1 $TMP
+sed '$d' $TMP2 >$TMP2.1 && mv $TMP2.1 $TMP2
+cmp -s $TMP $TMP2 || exit 1
+
+exit 0
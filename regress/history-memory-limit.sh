@@ -0,0 +1,69 @@
+#!/bin/sh
+
+# Test history-memory-limit removes history from the least recently active
+# pane first, leaves panes in copy mode alone until they leave it and does not
+# count cold lines that are no longer in the history.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Ltest"
+$TMUX kill-server 2>/dev/null
+
+$TMUX -f/dev/null new -d -x80 -y20 \; set -g history-limit 100000 || exit 1
+$TMUX neww -d "seq 1 20000; $TMUX wait -S done; cat" || exit 1
+$TMUX wait done || exit 1
+$TMUX neww -d "seq 1 20000; $TMUX wait -S done; cat" || exit 1
+$TMUX wait done || exit 1
+
+# The older window is emptied and the other trimmed to under the limit.
+$TMUX set -g history-memory-limit 1 || exit 1
+[ "$($TMUX display -pt:1 '#{history_size}')" = 0 ] || exit 1
+[ "$($TMUX display -pt:2 '#{history_size}')" -gt 0 ] || exit 1
+[ "$($TMUX display -pt:2 '#{history_all_bytes}')" -le 1048576 ] || exit 1
+[ "$($TMUX display -pt:2 '#{history_share}')" = 100 ] || exit 1
+
+# A pane in copy mode keeps its history.
+$TMUX set -g history-memory-limit 0 || exit 1
+$TMUX copy-mode -t:2 || exit 1
+$TMUX neww -d "seq 1 20000; $TMUX wait -S done; cat" || exit 1
+$TMUX wait done || exit 1
+SIZE=$($TMUX display -pt:2 '#{history_size}')
+$TMUX set -g history-memory-limit 1 || exit 1
+[ "$($TMUX display -pt:2 '#{history_size}')" = "$SIZE" ] || exit 1
+[ "$($TMUX display -pt:3 '#{history_size}')" = 0 ] || exit 1
+
+# A pane in copy mode over the limit is collected once it leaves copy mode
+# and there is more output, even if the total has not grown.
+$TMUX set -g history-memory-limit 0 || exit 1
+$TMUX neww -d "seq 1 20000; $TMUX wait -S done; cat" || exit 1
+$TMUX wait done || exit 1
+$TMUX copy-mode -t:4 || exit 1
+SIZE=$($TMUX display -pt:4 '#{history_size}')
+$TMUX set -g history-memory-limit 1 || exit 1
+[ "$($TMUX display -pt:4 '#{history_size}')" = "$SIZE" ] || exit 1
+$TMUX send -t:4 -X cancel || exit 1
+$TMUX send -t:3 x || exit 1
+sleep 1
+[ "$($TMUX display -pt:4 '#{history_size}')" -lt "$SIZE" ] || exit 1
+
+# Cold lines moved back onto the screen when a pane grows are not counted, so
+# the total is small and nothing is collected.
+$TMUX kill-server 2>/dev/null
+$TMUX -f/dev/null new -d -x80 -y10 \; \
+	set -g window-size manual \; \
+	set -g history-cold-limit 3 || exit 1
+$TMUX neww -d "seq 1 300; $TMUX wait -S done; cat" || exit 1
+$TMUX wait done || exit 1
+$TMUX neww -d "seq 1 40; $TMUX wait -S done; cat" || exit 1
+$TMUX wait done || exit 1
+SIZE=$($TMUX display -pt:2 '#{history_size}')
+$TMUX resizew -t:1 -y 400 || exit 1
+[ "$($TMUX display -pt:1 '#{history_bytes}')" = 0 ] || exit 1
+[ "$($TMUX display -pt:1 '#{history_all_bytes}')" -lt 1048576 ] || exit 1
+$TMUX set -g history-memory-limit 100 || exit 1
+[ "$($TMUX display -pt:2 '#{history_size}')" = "$SIZE" ] || exit 1
+
+$TMUX kill-server 2>/dev/null
+exit 0
@@ -0,0 +1,101 @@
+#!/bin/sh
+
+# Flood a pane with different kinds of output and check the server processes
+# it fast enough and without using too much memory.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Ltest"
+$TMUX kill-server 2>/dev/null
+
+TMP=$(mktemp -d)
+trap "rm -rf $TMP" 0 1 15
+
+# Minimum bytes processed per tick of server CPU (usually 10 ms) for each kind
+# of output and maximum resident memory in KB. The slowest of five runs of an
+# unoptimized (-O0) build was long 94461, wide 25230, scroll 59259, sgr 63967
+# and alternate 63754; each minimum is a third of that, so a failure means
+# something has got much slower.
+MAXRSS=65536
+
+awk 'BEGIN {
+	for (i = 0; i < 2000; i++) {
+		for (j = 0; j < 40; j++)
+			printf "long line %04d part %02d ", i, j
+		printf "\n"
+	}
+}' >$TMP/long || exit 1
+awk 'BEGIN {
+	for (i = 0; i < 20000; i++) {
+		for (j = 0; j < 30; j++)
+			printf "\344\270\255\346\226\207"
+		printf "%d\n", i
+	}
+}' >$TMP/wide || exit 1
+awk 'BEGIN {
+	for (i = 0; i < 20000; i++) {
+		printf "\033[%d;%dr\033[%dH", i % 5 + 2, 20 - i % 7, 20 - i % 7
+		printf "scrolling region line %d\n\n\n\033[r", i
+	}
+}' >$TMP/scroll || exit 1
+awk 'BEGIN {
+	for (i = 0; i < 100000; i++) {
+		printf "\033[%d;%d;%dm%c\033[38;5;%d;48;2;%d;%d;%dm%c", \
+		    i % 9 + 1, 30 + i % 8, 40 + i % 7, 65 + i % 26, i % 256, \
+		    i % 256, (i * 3) % 256, (i * 7) % 256, 97 + i % 26
+		if (i % 40 == 0)
+			printf "\033[m\n"
+	}
+}' >$TMP/sgr || exit 1
+awk 'BEGIN {
+	for (i = 0; i < 2000; i++) {
+		printf "\033[?1049h\033[H\033[2J"
+		for (j = 0; j < 10; j++)
+			printf "\033[%dHalternate screen %d", j + 1, i
+		printf "\033[?1049lnormal screen %d\n", i
+	}
+}' >$TMP/alternate || exit 1
+
+$TMUX -f/dev/null new -d -x80 -y24 || exit 1
+PID=$($TMUX display -p '#{pid}')
+if [ ! -d /proc/$PID ]; then
+	$TMUX kill-server 2>/dev/null
+	exit 0
+fi
+
+for i in long wide scroll sgr alternate; do
+	case $i in
+	long)
+		MINRATE=31000
+		;;
+	wide)
+		MINRATE=8000
+		;;
+	scroll)
+		MINRATE=19000
+		;;
+	sgr|alternate)
+		MINRATE=21000
+		;;
+	esac
+
+	SIZE=$(wc -c <$TMP/$i)
+	CMD="$TMUX wait go; cat $TMP/$i $TMP/$i; $TMUX wait -S done; cat"
+	$TMUX respawnp -k "$CMD" || exit 1
+	sleep 0.5
+	CPU=$(awk '{ print $14 + $15 }' /proc/$PID/stat)
+	$TMUX wait -S go || exit 1
+	$TMUX wait done || exit 1
+	CPU=$(($(awk '{ print $14 + $15 }' /proc/$PID/stat) - CPU))
+	RSS=$(awk '/^VmRSS/ { print $2 }' /proc/$PID/status)
+
+	[ $CPU -eq 0 ] && CPU=1
+	[ $((SIZE * 2 / CPU)) -ge $MINRATE ] || exit 1
+	[ $RSS -le $MAXRSS ] || exit 1
+	[ -n "$VERBOSE" ] && echo "$i: $((SIZE * 2)) bytes, $CPU ticks, $RSS KB"
+done
+
+$TMUX kill-server 2>/dev/null
+exit 0
@@ -0,0 +1,46 @@
+#!/bin/sh
+
+# Test pane-log-file and size rotation.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Ltest"
+$TMUX kill-server 2>/dev/null
+
+TMP=$(mktemp -d)
+trap "rm -rf $TMP" 0 1 15
+
+$TMUX -f/dev/null new -d -x40 -y10 "cat" || exit 1
+$TMUX set -g pane-log-file "$TMP/#{pane_id}.log" || exit 1
+LOG=$TMP/$($TMUX display -p '#{pane_id}').log
+
+# Output is written to the log.
+$TMUX send -l 'hello' \; send Enter || exit 1
+sleep 1
+[ "$(tr -d '\r' <$LOG)" = "$(printf 'hello\nhello')" ] || exit 1
+
+# The log is rotated when it is too big.
+$TMUX set -g pane-log-size 10 || exit 1
+$TMUX send -l 'world' \; send Enter || exit 1
+sleep 1
+[ -f $LOG.1 ] || exit 1
+[ "$(tr -d '\r' <$LOG.1)" = "$(printf 'hello\nhello\nworld\nworld')" ] || \
+	exit 1
+[ -s $LOG ] && exit 1
+
+# The next rotation uses the next name.
+$TMUX send -l 'second' \; send Enter || exit 1
+sleep 1
+[ "$(tr -d '\r' <$LOG.2)" = "$(printf 'second\nsecond')" ] || exit 1
+[ -s $LOG ] && exit 1
+
+# Unsetting the option stops logging.
+$TMUX set -gu pane-log-file || exit 1
+$TMUX send -l 'again' \; send Enter || exit 1
+sleep 1
+[ -s $LOG ] && exit 1
+
+$TMUX kill-server 2>/dev/null
+exit 0
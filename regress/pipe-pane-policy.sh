@@ -0,0 +1,64 @@
+#!/bin/sh
+
+# Test pipe-pane with a slow reader and each pipe-pane-policy.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Ltest"
+$TMUX kill-server 2>/dev/null
+
+TMP=$(mktemp)
+trap "rm -f $TMP" 0 1 15
+
+SIZE=4000000
+
+# Start a pane which writes SIZE bytes when told, pipe it with the given
+# policy and command and wait for the output to be written.
+run() {
+	$TMUX kill-server 2>/dev/null
+	: >$TMP
+	$TMUX -f/dev/null new -d \
+		"$TMUX wait go; head -c $SIZE /dev/zero|tr '\0' x;
+		$TMUX wait -S done; cat" || exit 1
+	$TMUX set -g pipe-pane-limit 1024 \; \
+		set -g pipe-pane-policy $1 \; \
+		pipep "$2" || exit 1
+	$TMUX wait -S go \; wait done || exit 1
+}
+
+# Wait until the pipe has written everything to the file.
+drain() {
+	n=0
+	while [ $n -lt 100 ]; do
+		[ $(wc -c <$TMP) -eq $SIZE ] && return
+		sleep 0.1
+		n=$((n + 1))
+	done
+	exit 1
+}
+
+# Dropped output is counted and the backlog stays near the limit.
+run drop "sleep 100"
+[ $($TMUX display -p '#{pane_pipe_dropped}') -gt 0 ] || exit 1
+[ $($TMUX display -p '#{pane_pipe_backlog}') -lt 100000 ] || exit 1
+
+# Spilled output is all written once the reader starts.
+run spill "sleep 1; cat >$TMP"
+drain
+[ $($TMUX display -p '#{pane_pipe_dropped}') -eq 0 ] || exit 1
+[ $($TMUX display -p '#{pane_pipe_backlog}') -eq 0 ] || exit 1
+
+# A blocked pane loses nothing.
+run block "sleep 1; cat >$TMP"
+drain
+[ $($TMUX display -p '#{pane_pipe_dropped}') -eq 0 ] || exit 1
+
+# There is no limit by default.
+$TMUX kill-server 2>/dev/null
+$TMUX -f/dev/null new -d || exit 1
+[ $($TMUX show -gv pipe-pane-limit) -eq 0 ] || exit 1
+
+$TMUX kill-server 2>/dev/null
+exit 0
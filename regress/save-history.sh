@@ -0,0 +1,41 @@
+#!/bin/sh
+
+# Test save-history and load-history keep attributes, colours and wide
+# characters and reject a damaged file.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Ltest"
+$TMUX kill-server 2>/dev/null
+
+TMP=$(mktemp)
+TMP2=$(mktemp)
+SAVED=$(mktemp)
+trap "rm -f $TMP $TMP2 $SAVED" 0 1 15
+
+$TMUX -f/dev/null new -d -x40 -y10 "
+	printf '\033[31mred\033[0m \033[1;38;2;1;2;3mrgb\033[0m\n'
+	printf '\344\275\240\345\245\275 wide\n'
+	seq 1 30
+	$TMUX wait -S done
+	cat" || exit 1
+$TMUX wait done || exit 1
+$TMUX capturep -epS- -E8 >$TMP || exit 1
+$TMUX saveh $SAVED || exit 1
+$TMUX kill-server 2>/dev/null
+
+# Loaded lines are added to the history unchanged.
+$TMUX -f/dev/null new -d -x40 -y10 "cat" || exit 1
+$TMUX loadh $SAVED || exit 1
+$TMUX capturep -epS- -E-1 >$TMP2 || exit 1
+cmp -s $TMP $TMP2 || exit 1
+
+# A truncated file is rejected.
+head -c 100 $SAVED >$TMP2
+$TMUX loadh $TMP2 2>/dev/null && exit 1
+$TMUX loadh $TMP 2>/dev/null && exit 1
+
+$TMUX kill-server 2>/dev/null
+exit 0
@@ -0,0 +1,60 @@
+#!/bin/sh
+
+# Attribute changes are drawn with the smallest SGR sequences that give the
+# same result.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Ltest"
+$TMUX kill-server 2>/dev/null
+TMUX2="$TEST_TMUX -Ltest2"
+$TMUX2 kill-server 2>/dev/null
+
+TMP=$(mktemp)
+IN=$(mktemp)
+OUT=$(mktemp)
+trap "rm -f $TMP $IN $OUT" 0 1 15
+
+awk 'BEGIN {
+	n = split("0 1 2 3 4 5 7 8 9 22 23 24 25 27 28 29 31 32 41 39 49 " \
+	    "38;5;123 48;5;200 1;4 0;7", a, " ")
+	x = 1
+	for (l = 0; l < 20; l++) {
+		for (i = 0; i < 60; i++) {
+			x = (x * 75 + 74) % 65537
+			printf "\033[%sm%c", a[x % n + 1], 65 + i % 26
+		}
+		printf "\033[m\r\n"
+	}
+}' >$IN
+
+$TMUX2 -f/dev/null new -d -x80 -y24 "cat $IN; cat" || exit 1
+$TMUX2 set -g status off || exit 1
+$TMUX2 set -g default-terminal tmux-256color || exit 1
+$TMUX -f/dev/null new -d -x80 -y24 || exit 1
+$TMUX set -g status off || exit 1
+$TMUX set -g default-terminal tmux-256color || exit 1
+$TMUX respawnw -k "$TMUX2 attach" || exit 1
+sleep 1
+
+# The outer pane must look the same as the inner.
+$TMUX capturep -ep >$TMP || exit 1
+$TMUX2 capturep -ep >$OUT || exit 1
+cmp -s $TMP $OUT || exit 1
+
+# A full redraw must look the same and write less than before attributes were
+# turned off individually: this redraw was 7436 bytes and is now 6245.
+W1=$($TMUX2 lsc -F '#{client_written}')
+$TMUX2 refresh -t$($TMUX2 lsc -F '#{client_name}') || exit 1
+sleep 1
+W2=$($TMUX2 lsc -F '#{client_written}')
+$TMUX capturep -ep >$TMP || exit 1
+cmp -s $TMP $OUT || exit 1
+
+$TMUX kill-server 2>/dev/null
+$TMUX2 kill-server 2>/dev/null
+[ $((W2 - W1)) -lt 6600 ] || exit 1
+
+exit 0
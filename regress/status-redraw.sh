@@ -0,0 +1,48 @@
+#!/bin/sh
+
+# When only part of the status line changes, only that part should be sent to
+# the terminal and the result should be the same as a full redraw.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Ltest"
+$TMUX kill-server 2>/dev/null
+TMUX2="$TEST_TMUX -Ltest2"
+$TMUX2 kill-server 2>/dev/null
+
+TMP=$(mktemp)
+OUT=$(mktemp)
+trap "rm -f $TMP $OUT" 0 1 15
+
+$TMUX2 -f/dev/null new -d -x80 -y24 "cat" || exit 1
+$TMUX2 set -g status-interval 0 || exit 1
+$TMUX2 set -g status-left-length 60 || exit 1
+$TMUX2 set -g status-left \
+	'#[fg=red]left #[fg=blue,bold]status #[default]line with some text' || \
+	exit 1
+$TMUX2 set -g status-right '#[reverse]#{pane_title}' || exit 1
+$TMUX2 selectp -T one || exit 1
+$TMUX -f/dev/null new -d -x80 -y24 || exit 1
+$TMUX set -g status off || exit 1
+$TMUX respawnw -k "$TMUX2 attach" || exit 1
+sleep 1
+
+for i in two three four; do
+	W1=$($TMUX2 lsc -F '#{client_written}')
+	$TMUX2 selectp -T $i || exit 1
+	sleep 1
+	W2=$($TMUX2 lsc -F '#{client_written}')
+	[ $((W2 - W1)) -lt 100 ] || exit 1
+	$TMUX capturep -ep >$TMP || exit 1
+
+	$TMUX2 refresh -t$($TMUX2 lsc -F '#{client_name}') || exit 1
+	sleep 1
+	$TMUX capturep -ep >$OUT || exit 1
+	cmp -s $TMP $OUT || exit 1
+done
+
+$TMUX kill-server 2>/dev/null
+$TMUX2 kill-server 2>/dev/null
+exit 0
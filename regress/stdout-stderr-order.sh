@@ -0,0 +1,27 @@
+#!/bin/sh
+
+# Output and errors written to the same file should be in the order the
+# commands produced them.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Ltest"
+$TMUX kill-server 2>/dev/null
+
+TMP=$(mktemp)
+trap "rm -f $TMP" 0 1 15
+
+$TMUX -f/dev/null new -d || exit 1
+$TMUX display -p 1 \; if true 'display -tnosuch -p x' \; display -p 2 \
+	>$TMP 2>&1
+$TMUX kill-server 2>/dev/null
+
+cat <<EOF|cmp -s $TMP - || exit 1
+1
+can't find pane: nosuch
+2
+EOF
+
+exit 0
@@ -0,0 +1,69 @@
+#!/bin/sh
+
+# targets by exact name, prefix and pattern should resolve or be ambiguous in
+# the same way after windows are renamed or swapped, including in other
+# sessions the window is linked into
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Ltest"
+$TMUX kill-server 2>/dev/null
+
+TMP=$(mktemp)
+trap "rm -f $TMP" 0 1 15
+
+$TMUX -f/dev/null new -d -s alpha -n foo || exit 1
+for i in foobar bar1 bar2 'x[y' foo; do
+	$TMUX neww -d -n "$i" || exit 1
+done
+for i in alphabet beta gamma1 gamma2; do
+	$TMUX new -d -s "$i" || exit 1
+done
+
+for i in alpha:foo alpha:fooba alpha:ba 'alpha:bar*' 'alpha:*1' \
+    'alpha:b*2' 'alpha:x\[y' alpha:x al be 'gam*' 'g*1' '*ta' alpha:foob; do
+	$TMUX display -pt "$i" '#{session_name}:#{window_index}' 2>&1
+done >$TMP
+$TMUX renamew -t alpha:1 zzz || exit 1
+$TMUX display -pt alpha:foob '#{window_name}' >>$TMP 2>&1
+$TMUX display -pt alpha:zz '#{window_name}' >>$TMP 2>&1
+$TMUX linkw -s alpha:zzz -t beta:5 || exit 1
+$TMUX display -pt beta:zz '#{window_index}' >>$TMP 2>&1
+$TMUX renamew -t alpha:zzz yyy || exit 1
+$TMUX display -pt beta:zz '#{window_index}' >>$TMP 2>&1
+$TMUX display -pt beta:yy '#{window_index}' >>$TMP 2>&1
+$TMUX new -d -s swap -n aaa \; neww -d -n bbb \; neww -d -n ccc || exit 1
+$TMUX display -pt swap:aaa '#{window_index}' >>$TMP 2>&1
+$TMUX swapw -s swap:0 -t swap:2 || exit 1
+$TMUX display -pt swap:aaa '#{window_index}' >>$TMP 2>&1
+$TMUX display -pt swap:ccc '#{window_index}' >>$TMP 2>&1
+$TMUX kill-server 2>/dev/null
+
+cat <<EOF|cmp -s $TMP - || exit 1
+can't find window: foo
+alpha:1
+can't find window: ba
+can't find window: bar*
+alpha:2
+alpha:3
+alpha:4
+alpha:4
+can't find pane: al
+beta:0
+can't find pane: gam*
+gamma1:0
+beta:0
+alpha:1
+can't find window: foob
+zzz
+5
+can't find window: zz
+5
+0
+2
+0
+EOF
+
+exit 0
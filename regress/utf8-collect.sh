@@ -0,0 +1,47 @@
+#!/bin/sh
+
+# Wide and other UTF-8 characters written in runs, wrapping and overwriting
+# each other, must look the same on an attached client as in the pane.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Ltest"
+$TMUX kill-server 2>/dev/null
+TMUX2="$TEST_TMUX -Ltest2"
+$TMUX2 kill-server 2>/dev/null
+
+TMP=$(mktemp)
+IN=$(mktemp)
+OUT=$(mktemp)
+trap "rm -f $TMP $IN $OUT" 0 1 15
+
+awk 'BEGIN {
+	n = split("a bc \303\251 \344\270\255 \342\224\200 \357\274\241 " \
+	    "\360\237\230\200 \033[1m \033[m \033[31m", a, " ")
+	x = 1
+	for (i = 0; i < 400; i++) {
+		x = (x * 75 + 74) % 65537
+		printf "%s", a[x % n + 1]
+		if (i % 50 == 49)
+			printf "\r\n"
+		if (i % 70 == 69)
+			printf "\033[%dA\033[%dG", x % 3 + 1, x % 15 + 1
+	}
+}' >$IN
+
+$TMUX2 -f/dev/null new -d -x15 -y10 "sleep 1; cat $IN; cat" || exit 1
+$TMUX2 set -g status off || exit 1
+$TMUX -f/dev/null new -d -x15 -y10 || exit 1
+$TMUX set -g status off || exit 1
+$TMUX respawnw -k "$TMUX2 -u attach" || exit 1
+sleep 2
+
+$TMUX capturep -ep >$TMP || exit 1
+$TMUX2 capturep -ep >$OUT || exit 1
+$TMUX kill-server 2>/dev/null
+$TMUX2 kill-server 2>/dev/null
+cmp -s $TMP $OUT || exit 1
+
+exit 0
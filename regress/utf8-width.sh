@@ -0,0 +1,39 @@
+#!/bin/sh
+
+# Check the widths given to some UTF-8 characters by looking at where the
+# cursor ends up after printing them.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -Ltest"
+$TMUX kill-server 2>/dev/null
+
+$TMUX -f/dev/null new -d -x40 -y2 "cat" || exit 1
+sleep 1
+
+check() {
+	$TMUX respawnp -k "printf '$1'; cat" || exit 1
+	sleep 0.5
+	x=$($TMUX display -p '#{cursor_x}')
+	if [ "$x" != "$2" ]; then
+		echo "$1: width $x, expected $2"
+		exit 1
+	fi
+}
+
+check 'a' 1
+check '\303\251' 1
+check 'e\314\201' 1
+check '\344\270\255' 2
+check '\357\274\241' 2
+check '\360\237\230\200' 2
+check '\360\240\200\200' 2
+check '\341\204\200\341\205\241' 2
+check '\342\200\213' 0
+check '\302\255' 1
+check '\343\200\201a' 3
+
+$TMUX kill-server 2>/dev/null
+exit 0
@@ -25,7 +25,7 @@
 
 static void	screen_redraw_draw_borders(struct screen_redraw_ctx *);
 static void	screen_redraw_draw_panes(struct screen_redraw_ctx *);
-static void	screen_redraw_draw_status(struct screen_redraw_ctx *);
+static void	screen_redraw_draw_status(struct screen_redraw_ctx *, int);
 static void	screen_redraw_draw_pane(struct screen_redraw_ctx *,
 		    struct window_pane *);
 
@@ -42,6 +42,10 @@ static void	screen_redraw_draw_pane(struct screen_redraw_ctx *,
 #define CELL_RIGHTJOIN 10
 #define CELL_JOIN 11
 #define CELL_OUTSIDE 12
+#define CELL_TYPE 0xf
+
+#define CELL_ACTIVE 0x10
+#define CELL_MARKED 0x20
 
 #define CELL_BORDERS " xqlkmjwvtun~"
 
@@ -76,9 +80,8 @@ screen_redraw_cell_border1(struct window_pane *wp, u_int px, u_int py)
 
 /* Check if a cell is on the pane border. */
 static int
-screen_redraw_cell_border(struct client *c, u_int px, u_int py)
+screen_redraw_cell_border(struct window *w, u_int px, u_int py)
 {
-	struct window		*w = c->session->curw->window;
 	struct window_pane	*wp;
 	int			 retval;
 
@@ -95,10 +98,9 @@ screen_redraw_cell_border(struct client *c, u_int px, u_int py)
 
 /* Check if cell inside a pane. */
 static int
-screen_redraw_check_cell(struct client *c, u_int px, u_int py, int pane_status,
+screen_redraw_check_cell(struct window *w, u_int px, u_int py, int pane_status,
     struct window_pane **wpp)
 {
-	struct window		*w = c->session->curw->window;
 	struct window_pane	*wp;
 	int			 borders;
 	u_int			 right, line;
@@ -137,7 +139,7 @@ screen_redraw_check_cell(struct client *c, u_int px, u_int py, int pane_status,
 			continue;
 
 		/* If definitely inside, return so. */
-		if (!screen_redraw_cell_border(c, px, py))
+		if (!screen_redraw_cell_border(w, px, py))
 			return (CELL_INSIDE);
 
 		/*
@@ -145,18 +147,18 @@ screen_redraw_check_cell(struct client *c, u_int px, u_int py, int pane_status,
 		 * 4), right, top, and bottom (bit 1) of this cell are borders.
 		 */
 		borders = 0;
-		if (px == 0 || screen_redraw_cell_border(c, px - 1, py))
+		if (px == 0 || screen_redraw_cell_border(w, px - 1, py))
 			borders |= 8;
-		if (px <= w->sx && screen_redraw_cell_border(c, px + 1, py))
+		if (px <= w->sx && screen_redraw_cell_border(w, px + 1, py))
 			borders |= 4;
 		if (pane_status == PANE_STATUS_TOP) {
-			if (py != 0 && screen_redraw_cell_border(c, px, py - 1))
+			if (py != 0 && screen_redraw_cell_border(w, px, py - 1))
 				borders |= 2;
 		} else {
-			if (py == 0 || screen_redraw_cell_border(c, px, py - 1))
+			if (py == 0 || screen_redraw_cell_border(w, px, py - 1))
 				borders |= 2;
 		}
-		if (py <= w->sy && screen_redraw_cell_border(c, px, py + 1))
+		if (py <= w->sy && screen_redraw_cell_border(w, px, py + 1))
 			borders |= 1;
 
 		/*
@@ -246,6 +248,65 @@ screen_redraw_check_is(u_int px, u_int py, int type, int pane_status,
 	return (1);
 }
 
+/* Discard the cached border map, for example when the layout changes. */
+void
+screen_redraw_invalidate(struct window *w)
+{
+	free(w->border_map);
+	w->border_map = NULL;
+}
+
+/*
+ * Get the border map for a window, building it if it is out of date. This
+ * holds the cell type for every cell in the window (plus the right and bottom
+ * edges), flagged with whether it is on the border of the active or marked
+ * pane, so drawing the borders does not need to look at every pane for every
+ * cell.
+ */
+static u_char *
+screen_redraw_get_borders(struct window *w, int pane_status,
+    struct window_pane *marked)
+{
+	struct window_pane	*wp, *active = w->active;
+	u_int			 x, y, sx = w->sx + 1, sy = w->sy + 1;
+	u_char			*map, type;
+
+	if (w->border_map != NULL &&
+	    w->border_sx == w->sx &&
+	    w->border_sy == w->sy &&
+	    w->border_status == pane_status &&
+	    w->border_active == active &&
+	    w->border_marked == marked)
+		return (w->border_map);
+	log_debug("%s: @%u %ux%u", __func__, w->id, w->sx, w->sy);
+
+	free(w->border_map);
+	map = w->border_map = xreallocarray(NULL, sy, sx);
+	w->border_sx = w->sx;
+	w->border_sy = w->sy;
+	w->border_status = pane_status;
+	w->border_active = active;
+	w->border_marked = marked;
+
+	for (y = 0; y < sy; y++) {
+		for (x = 0; x < sx; x++) {
+			type = screen_redraw_check_cell(w, x, y, pane_status,
+			    &wp);
+			if (type != CELL_INSIDE) {
+				if (screen_redraw_check_is(x, y, type,
+				    pane_status, w, active, wp))
+					type |= CELL_ACTIVE;
+				if (marked != NULL &&
+				    screen_redraw_check_is(x, y, type,
+				    pane_status, w, marked, wp))
+					type |= CELL_MARKED;
+			}
+			map[(y * sx) + x] = type;
+		}
+	}
+	return (map);
+}
+
 /* Update pane status. */
 static int
 screen_redraw_make_pane_status(struct client *c, struct window *w,
@@ -445,7 +506,7 @@ screen_redraw_screen(struct client *c)
 		screen_redraw_draw_panes(&ctx);
 	if (ctx.statuslines != 0 &&
 	    (flags & (CLIENT_REDRAWSTATUS|CLIENT_REDRAWSTATUSALWAYS)))
-		screen_redraw_draw_status(&ctx);
+		screen_redraw_draw_status(&ctx, flags & CLIENT_REDRAWWINDOW);
 	if (c->overlay_draw != NULL && (flags & CLIENT_REDRAWOVERLAY))
 		c->overlay_draw(c, &ctx);
 	tty_reset(&c->tty);
@@ -469,31 +530,17 @@ screen_redraw_pane(struct client *c, struct window_pane *wp)
 /* Draw a border cell. */
 static void
 screen_redraw_draw_borders_cell(struct screen_redraw_ctx *ctx, u_int i, u_int j,
-    struct grid_cell *m_active_gc, struct grid_cell *active_gc,
+    u_char type, struct grid_cell *m_active_gc, struct grid_cell *active_gc,
     struct grid_cell *m_other_gc, struct grid_cell *other_gc)
 {
-	struct client		*c = ctx->c;
-	struct session		*s = c->session;
-	struct window		*w = s->curw->window;
-	struct tty		*tty = &c->tty;
-	struct window_pane	*wp;
-	struct window_pane	*active = w->active;
-	struct window_pane	*marked = marked_pane.wp;
-	u_int			 type, x = ctx->ox + i, y = ctx->oy + j;
-	int			 flag, pane_status = ctx->pane_status;
+	struct tty		*tty = &ctx->c->tty;
 
-	type = screen_redraw_check_cell(c, x, y, pane_status, &wp);
-	if (type == CELL_INSIDE)
-		return;
-	flag = screen_redraw_check_is(x, y, type, pane_status, w, active, wp);
-
-	if (server_is_marked(s, s->curw, marked_pane.wp) &&
-	    screen_redraw_check_is(x, y, type, pane_status, w, marked, wp)) {
-		if (flag)
+	if (type & CELL_MARKED) {
+		if (type & CELL_ACTIVE)
 			tty_attributes(tty, m_active_gc, NULL);
 		else
 			tty_attributes(tty, m_other_gc, NULL);
-	} else if (flag)
+	} else if (type & CELL_ACTIVE)
 		tty_attributes(tty, active_gc, NULL);
 	else
 		tty_attributes(tty, other_gc, NULL);
@@ -501,7 +548,7 @@ screen_redraw_draw_borders_cell(struct screen_redraw_ctx *ctx, u_int i, u_int j,
 		tty_cursor(tty, i, ctx->statuslines + j);
 	else
 		tty_cursor(tty, i, j);
-	tty_putc(tty, CELL_BORDERS[type]);
+	tty_putc(tty, CELL_BORDERS[type & CELL_TYPE]);
 }
 
 /* Draw the borders. */
@@ -514,7 +561,9 @@ screen_redraw_draw_borders(struct screen_redraw_ctx *ctx)
 	struct tty		*tty = &c->tty;
 	struct options		*oo = w->options;
 	struct grid_cell	 m_active_gc, active_gc, m_other_gc, other_gc;
-	u_int		 	 i, j;
+	struct window_pane	*marked = NULL;
+	u_char			*map, type;
+	u_int		 	 i, j, x, y;
 
 	log_debug("%s: %s @%u", __func__, c->name, w->id);
 
@@ -527,9 +576,21 @@ screen_redraw_draw_borders(struct screen_redraw_ctx *ctx)
 	memcpy(&m_active_gc, &active_gc, sizeof m_active_gc);
 	m_active_gc.attr ^= GRID_ATTR_REVERSE;
 
+	if (server_is_marked(s, s->curw, marked_pane.wp))
+		marked = marked_pane.wp;
+	map = screen_redraw_get_borders(w, ctx->pane_status, marked);
+
 	for (j = 0; j < tty->sy - ctx->statuslines; j++) {
+		y = ctx->oy + j;
 		for (i = 0; i < tty->sx; i++) {
-			screen_redraw_draw_borders_cell(ctx, i, j,
+			x = ctx->ox + i;
+			if (x > w->sx || y > w->sy)
+				type = CELL_OUTSIDE;
+			else
+				type = map[(y * (w->sx + 1)) + x];
+			if (type == CELL_INSIDE)
+				continue;
+			screen_redraw_draw_borders_cell(ctx, i, j, type,
 			    &m_active_gc, &active_gc, &m_other_gc, &other_gc);
 		}
 	}
@@ -551,24 +612,120 @@ screen_redraw_draw_panes(struct screen_redraw_ctx *ctx)
 	}
 }
 
-/* Draw the status line. */
+/* Is this status line cell the same as when it was last drawn? */
+static int
+screen_redraw_status_same(struct grid *gd, struct grid *drawn, u_int px,
+    u_int py)
+{
+	struct grid_cell	gc, last;
+
+	grid_get_cell(gd, px, py, &gc);
+	grid_get_cell(drawn, px, py, &last);
+	return (gc.us == last.us && grid_cells_equal(&gc, &last));
+}
+
+/* Draw only the parts of a status line that have changed. */
 static void
-screen_redraw_draw_status(struct screen_redraw_ctx *ctx)
+screen_redraw_draw_status_changes(struct screen_redraw_ctx *ctx,
+    struct screen *s, struct grid *drawn, u_int py, u_int y)
 {
-	struct client	*c = ctx->c;
-	struct window	*w = c->session->curw->window;
-	struct tty	*tty = &c->tty;
-	struct screen	*s = c->status.active;
-	u_int		 i, y;
+	struct tty		*tty = &ctx->c->tty;
+	struct grid		*gd = s->grid;
+	struct grid_cell	 gc;
+	u_int			 sx = screen_size_x(s), px, end, same;
 
-	log_debug("%s: %s @%u", __func__, c->name, w->id);
+	px = 0;
+	for (;;) {
+		while (px < sx && screen_redraw_status_same(gd, drawn, px, py))
+			px++;
+		if (px == sx)
+			break;
+
+		/*
+		 * Find the end of the changes, joining together runs with only
+		 * a few unchanged cells between them because moving the
+		 * cursor costs about as much as drawing the cells.
+		 */
+		end = px + 1;
+		for (;;) {
+			while (end < sx &&
+			    !screen_redraw_status_same(gd, drawn, end, py))
+				end++;
+			for (same = 0; end + same < sx; same++) {
+				if (!screen_redraw_status_same(gd, drawn,
+				    end + same, py))
+					break;
+			}
+			if (end + same == sx || same > 4)
+				break;
+			end += same;
+		}
+
+		/* Don't start or end in the middle of a wide character. */
+		for (; px > 0; px--) {
+			grid_get_cell(gd, px, py, &gc);
+			if (~gc.flags & GRID_FLAG_PADDING)
+				break;
+		}
+		for (; end < sx; end++) {
+			grid_get_cell(gd, end, py, &gc);
+			if (~gc.flags & GRID_FLAG_PADDING)
+				break;
+		}
+
+		tty_draw_line(tty, NULL, s, px, py, end - px, px, y);
+		px = end;
+	}
+}
+
+/*
+ * Draw the status line. Unless the whole screen is being redrawn, only the
+ * cells that differ from the last status line drawn are sent to the terminal.
+ */
+static void
+screen_redraw_draw_status(struct screen_redraw_ctx *ctx, int full)
+{
+	struct client		*c = ctx->c;
+	struct status_line	*sl = &c->status;
+	struct window		*w = c->session->curw->window;
+	struct tty		*tty = &c->tty;
+	struct screen		*s = sl->active;
+	u_int			 i, y, sx, sy;
+
+	log_debug("%s: %s @%u%s", __func__, c->name, w->id,
+	    full ? " (full)" : "");
 
 	if (ctx->statustop)
 		y = 0;
 	else
 		y = c->tty.sy - ctx->statuslines;
-	for (i = 0; i < ctx->statuslines; i++)
-		tty_draw_line(tty, NULL, s, 0, i, UINT_MAX, 0, y + i);
+
+	sx = screen_size_x(s);
+	sy = screen_size_y(s);
+	if (sl->drawn != NULL &&
+	    (full ||
+	    s != &sl->screen ||
+	    sl->drawn->sx != sx ||
+	    sl->drawn->sy != sy ||
+	    sy != ctx->statuslines)) {
+		grid_destroy(sl->drawn);
+		sl->drawn = NULL;
+	}
+
+	for (i = 0; i < ctx->statuslines; i++) {
+		if (sl->drawn == NULL)
+			tty_draw_line(tty, NULL, s, 0, i, UINT_MAX, 0, y + i);
+		else
+			screen_redraw_draw_status_changes(ctx, s, sl->drawn, i,
+			    y + i);
+	}
+
+	/* Keep a copy of the status line if it can be used next time. */
+	if (s == &sl->screen && sy == ctx->statuslines) {
+		if (sl->drawn == NULL)
+			sl->drawn = grid_create(sx, sy, 0);
+		grid_duplicate_lines(sl->drawn, 0, s->grid, 0, sy);
+	}
 }
 
 /* Draw one pane. */
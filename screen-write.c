@@ -35,16 +35,14 @@ static int	screen_write_overwrite(struct screen_write_ctx *,
 static const struct grid_cell *screen_write_combine(struct screen_write_ctx *,
 		    const struct utf8_data *, u_int *);
 
-static const struct grid_cell screen_write_pad_cell = {
-	{ { 0 }, 0, 0, 0 }, 0, GRID_FLAG_PADDING, 0, 8, 8
-};
-
 struct screen_write_collect_item {
 	u_int			 x;
 	int			 wrapped;
 
 	u_int			 used;
+	u_int			 width;
 	char			 data[256];
+	u_char			 widths[256]; /* at first byte of each character */
 
 	struct grid_cell	 gc;
 
@@ -1273,7 +1271,8 @@ screen_write_collect_flush(struct screen_write_ctx *ctx, int scroll_only)
 			ttyctx.cell = &ci->gc;
 			ttyctx.wrapped = ci->wrapped;
 			ttyctx.ptr = ci->data;
-			ttyctx.num = ci->used;
+			ttyctx.ptrlen = ci->used;
+			ttyctx.num = ci->width;
 			tty_write(tty_cmd_cells, &ttyctx);
 
 			items++;
@@ -1324,8 +1323,14 @@ screen_write_collect_end(struct screen_write_ctx *ctx)
 	}
 
 	memcpy(&gc, &ci->gc, sizeof gc);
-	grid_view_set_cells(s->grid, s->cx, s->cy, &gc, ci->data, ci->used);
-	screen_write_set_cursor(ctx, s->cx + ci->used, -1);
+	if (ci->used == ci->width) {
+		grid_view_set_cells(s->grid, s->cx, s->cy, &gc, ci->data,
+		    ci->used, NULL);
+	} else {
+		grid_view_set_cells(s->grid, s->cx, s->cy, &gc, ci->data,
+		    ci->used, ci->widths);
+	}
+	screen_write_set_cursor(ctx, s->cx + ci->width, -1);
 
 	for (xx = s->cx; xx < screen_size_x(s); xx++) {
 		grid_view_get_cell(s->grid, xx, s->cy, &gc);
@@ -1343,17 +1348,21 @@ screen_write_collect_add(struct screen_write_ctx *ctx,
 	struct screen				*s = ctx->s;
 	struct screen_write_collect_item	*ci;
 	u_int					 sx = screen_size_x(s);
+	u_int					 width, size;
 	int					 collect;
 
 	/*
 	 * Don't need to check that the attributes and whatnot are still the
 	 * same - input_parse will end the collection when anything that isn't
 	 * a plain character is encountered. Also nothing should make it here
-	 * that isn't a single ASCII character.
+	 * that isn't a single ASCII character or a UTF-8 character of width
+	 * one or two.
 	 */
 
 	collect = 1;
-	if (gc->data.width != 1 || gc->data.size != 1 || *gc->data.data >= 0x7f)
+	if (gc->data.width == 0 || gc->data.width > 2 || gc->data.width > sx)
+		collect = 0;
+	else if (gc->data.size == 1 && *gc->data.data >= 0x7f)
 		collect = 0;
 	else if (gc->attr & GRID_ATTR_CHARSET)
 		collect = 0;
@@ -1371,11 +1380,13 @@ screen_write_collect_add(struct screen_write_ctx *ctx,
 	}
 	ctx->cells++;
 
-	if (s->cx > sx - 1 || ctx->item->used > sx - 1 - s->cx)
+	width = gc->data.width;
+	size = gc->data.size;
+	if (s->cx > sx - width || ctx->item->width > sx - width - s->cx)
 		screen_write_collect_end(ctx);
 	ci = ctx->item; /* may have changed */
 
-	if (s->cx > sx - 1) {
+	if (s->cx > sx - width) {
 		log_debug("%s: wrapped at %u,%u", __func__, s->cx, s->cy);
 		ci->wrapped = 1;
 		screen_write_linefeed(ctx, 1, 8);
@@ -1384,8 +1395,11 @@ screen_write_collect_add(struct screen_write_ctx *ctx,
 
 	if (ci->used == 0)
 		memcpy(&ci->gc, gc, sizeof ci->gc);
-	ci->data[ci->used++] = gc->data.data[0];
-	if (ci->used == (sizeof ci->data) - 1)
+	ci->widths[ci->used] = width;
+	memcpy(ci->data + ci->used, gc->data.data, size);
+	ci->used += size;
+	ci->width += width;
+	if (ci->used > (sizeof ci->data) - 1 - UTF8_SIZE)
 		screen_write_collect_end(ctx);
 }
 
@@ -1464,7 +1478,7 @@ screen_write_cell(struct screen_write_ctx *ctx, const struct grid_cell *gc)
 	 */
 	for (xx = s->cx + 1; xx < s->cx + width; xx++) {
 		log_debug("%s: new padding at %u,%u", __func__, xx, s->cy);
-		grid_view_set_cell(gd, xx, s->cy, &screen_write_pad_cell);
+		grid_view_set_cell(gd, xx, s->cy, &grid_padding_cell);
 		skip = 0;
 	}
 
@@ -259,8 +259,7 @@ screen_resize_y(struct screen *s, u_int sy)
 		 */
 		available = s->cy;
 		if (gd->flags & GRID_HISTORY) {
-			gd->hscrolled += needed;
-			gd->hsize += needed;
+			grid_add_history(gd, needed);
 		} else if (needed > 0 && available > 0) {
 			if (available > needed)
 				available = needed;
@@ -284,8 +283,7 @@ screen_resize_y(struct screen *s, u_int sy)
 		if (gd->flags & GRID_HISTORY && available > 0) {
 			if (available > needed)
 				available = needed;
-			gd->hscrolled -= available;
-			gd->hsize -= available;
+			grid_remove_history(gd, available);
 			s->cy += available;
 		} else
 			available = 0;
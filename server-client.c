@@ -18,6 +18,7 @@
 
 #include <sys/types.h>
 #include <sys/ioctl.h>
+#include <sys/stat.h>
 #include <sys/uio.h>
 
 #include <errno.h>
@@ -30,6 +31,9 @@
 
 #include "tmux.h"
 
+/* Messages queued to a client before its stdout callback must wait. */
+#define SERVER_CLIENT_QUEUED 8
+
 static void	server_client_free(int, short, void *);
 static void	server_client_check_focus(struct window_pane *);
 static void	server_client_check_resize(struct window_pane *);
@@ -48,6 +52,11 @@ static void	server_client_dispatch(struct imsg *, void *);
 static void	server_client_dispatch_command(struct client *, struct imsg *);
 static void	server_client_dispatch_identify(struct client *, struct imsg *);
 static void	server_client_dispatch_shell(struct client *);
+static int	server_client_open_fd(struct client *, int, short,
+		    struct event *, int *, void (*)(int, short, void *));
+static void	server_client_stdin_event(int, short, void *);
+static void	server_client_stdout_event(int, short, void *);
+static void	server_client_check_stdout(struct client *);
 
 /* Number of attached clients. */
 u_int
@@ -191,6 +200,8 @@ server_client_create(int fd)
 	c->environ = environ_create();
 
 	c->fd = -1;
+	c->stdin_fd = -1;
+	c->stdout_fd = -1;
 	c->cwd = NULL;
 
 	TAILQ_INIT(&c->queue);
@@ -273,6 +284,8 @@ server_client_lost(struct client *c)
 
 	if (c->stdin_callback != NULL)
 		c->stdin_callback(c, 1, c->stdin_callback_data);
+	if (c->stdout_callback != NULL)
+		c->stdout_callback(c, 1, c->stdout_callback_data);
 
 	TAILQ_REMOVE(&clients, c, entry);
 	log_debug("lost client %p", c);
@@ -286,6 +299,14 @@ server_client_lost(struct client *c)
 	free(c->ttyname);
 	free(c->term);
 
+	if (c->stdin_fd != -1) {
+		event_del(&c->stdin_event);
+		close(c->stdin_fd);
+	}
+	if (c->stdout_fd != -1) {
+		event_del(&c->stdout_event);
+		close(c->stdout_fd);
+	}
 	evbuffer_free(c->stdin_data);
 	evbuffer_free(c->stdout_data);
 	if (c->stderr_data != c->stdout_data)
@@ -1250,6 +1271,8 @@ server_client_loop(void)
 
 	TAILQ_FOREACH(c, &clients, entry) {
 		server_client_check_exit(c);
+		if (c->stdout_fd == -1)
+			server_client_check_stdout(c);
 		if (c->session != NULL) {
 			server_client_check_redraw(c);
 			server_client_reset_state(c);
@@ -1278,6 +1301,10 @@ server_client_loop(void)
 		}
 		check_window_name(w);
 	}
+
+	/* Write out anything generated for clients in this loop. */
+	TAILQ_FOREACH(c, &clients, entry)
+		tty_flush(&c->tty);
 }
 
 /* Check if we need to force a resize. */
@@ -1610,7 +1637,7 @@ server_client_check_redraw(struct client *c)
 			}
 		}
 	}
-	if (needed && (left = EVBUFFER_LENGTH(tty->out)) != 0) {
+	if (needed && (left = tty_output_pending(tty)) != 0) {
 		log_debug("%s: redraw deferred (%zu left)", c->name, left);
 		if (!evtimer_initialized(&ev))
 			evtimer_set(&ev, server_client_redraw_timer, NULL);
@@ -1661,7 +1688,7 @@ server_client_check_redraw(struct client *c)
 		 * was empty, so we can record how many bytes the redraw
 		 * generated.
 		 */
-		c->redraw = EVBUFFER_LENGTH(tty->out);
+		c->redraw = tty_output_pending(tty);
 		log_debug("%s: redraw added %zu bytes", c->name, c->redraw);
 	}
 }
@@ -1718,6 +1745,7 @@ server_client_dispatch(struct imsg *imsg, void *arg)
 	case MSG_IDENTIFY_TTYNAME:
 	case MSG_IDENTIFY_CWD:
 	case MSG_IDENTIFY_STDIN:
+	case MSG_IDENTIFY_STDOUT:
 	case MSG_IDENTIFY_ENVIRON:
 	case MSG_IDENTIFY_CLIENTPID:
 	case MSG_IDENTIFY_DONE:
@@ -1800,7 +1828,7 @@ server_client_command_done(struct cmdq_item *item, __unused void *data)
 {
 	struct client	*c = item->client;
 
-	if (~c->flags & CLIENT_ATTACHED)
+	if ((c->flags & (CLIENT_ATTACHED|CLIENT_BATCH)) == 0)
 		c->flags |= CLIENT_EXIT;
 	return (CMD_RETURN_NORMAL);
 }
@@ -1834,6 +1862,13 @@ server_client_dispatch_command(struct client *c, struct imsg *imsg)
 		goto error;
 	}
 
+	/*
+	 * A batch client with no command just stays connected and reads
+	 * commands from stdin.
+	 */
+	if (argc == 0 && (c->flags & CLIENT_BATCH))
+		return;
+
 	if (argc == 0) {
 		argc = 1;
 		argv = xcalloc(1, sizeof *argv);
@@ -1920,6 +1955,14 @@ server_client_dispatch_identify(struct client *c, struct imsg *imsg)
 		c->fd = imsg->fd;
 		log_debug("client %p IDENTIFY_STDIN %d", c, imsg->fd);
 		break;
+	case MSG_IDENTIFY_STDOUT:
+		if (datalen != 0)
+			fatalx("bad MSG_IDENTIFY_STDOUT size");
+		if (c->stdout_fd != -1)
+			close(c->stdout_fd);
+		c->stdout_fd = imsg->fd;
+		log_debug("client %p IDENTIFY_STDOUT %d", c, imsg->fd);
+		break;
 	case MSG_IDENTIFY_ENVIRON:
 		if (datalen == 0 || data[datalen - 1] != '\0')
 			fatalx("bad MSG_IDENTIFY_ENVIRON string");
@@ -1966,9 +2009,15 @@ server_client_dispatch_identify(struct client *c, struct imsg *imsg)
 
 		close(c->fd);
 		c->fd = -1;
+		if (c->stdout_fd != -1) {
+			close(c->stdout_fd);
+			c->stdout_fd = -1;
+		}
 	} else if (c->fd != -1) {
 		if (tty_init(&c->tty, c, c->fd, c->term) != 0) {
-			close(c->fd);
+			c->stdin_fd = server_client_open_fd(c, c->fd, EV_READ,
+			    &c->stdin_event, &c->stdin_poll,
+			    server_client_stdin_event);
 			c->fd = -1;
 		} else {
 			if (c->flags & CLIENT_UTF8)
@@ -1979,6 +2028,11 @@ server_client_dispatch_identify(struct client *c, struct imsg *imsg)
 			c->flags |= CLIENT_TERMINAL;
 		}
 	}
+	if (c->stdout_fd != -1) {
+		c->stdout_fd = server_client_open_fd(c, c->stdout_fd,
+		    EV_WRITE, &c->stdout_event, &c->stdout_poll,
+		    server_client_stdout_event);
+	}
 
 	/*
 	 * If this is the first client that has finished identifying, load
@@ -2005,6 +2059,137 @@ server_client_dispatch_shell(struct client *c)
 	proc_kill_peer(c->peer);
 }
 
+/*
+ * Set up a stdin or stdout file descriptor passed by the client so the server
+ * can read or write it directly rather than passing the data in messages.
+ * Terminals are left to the client. Pipes and sockets are waited on as usual;
+ * anything else (such as files and /dev/null) can't be polled but never
+ * blocks, so it is treated as always ready.
+ *
+ * Making the descriptor nonblocking sets O_NONBLOCK on the open file
+ * description, which is shared with the client and with any other process
+ * using the same file, such as other commands writing to the same pipe. They
+ * may get EAGAIN until the client exits and puts it back to blocking.
+ */
+static int
+server_client_open_fd(struct client *c, int fd, short events,
+    struct event *ev, int *poll, void (*cb)(int, short, void *))
+{
+	struct stat	sb;
+
+	if (isatty(fd) || fstat(fd, &sb) != 0) {
+		close(fd);
+		return (-1);
+	}
+	setblocking(fd, 0);
+
+	*poll = (S_ISFIFO(sb.st_mode) || S_ISSOCK(sb.st_mode));
+	if (*poll)
+		event_set(ev, fd, events, cb, c);
+	else
+		evtimer_set(ev, cb, c);
+	log_debug("client %p fd %d is %s", c, fd, *poll ? "polled" : "ready");
+	return (fd);
+}
+
+/* Wait until a passed file descriptor is ready. */
+static void
+server_client_wait_fd(struct event *ev, int poll)
+{
+	struct timeval	tv = { .tv_sec = 0 };
+
+	if (poll)
+		event_add(ev, NULL);
+	else
+		evtimer_add(ev, &tv);
+}
+
+/* Event callback to read from client stdin. */
+static void
+server_client_stdin_event(__unused int fd, __unused short events, void *arg)
+{
+	struct client	*c = arg;
+	int		 n;
+
+	if (c->stdin_callback == NULL)
+		return;
+
+	n = evbuffer_read(c->stdin_data, c->stdin_fd, 65536);
+	if (n == -1 && (errno == EINTR || errno == EAGAIN)) {
+		server_client_wait_fd(&c->stdin_event, c->stdin_poll);
+		return;
+	}
+	log_debug("%s: client %p, read %d", __func__, c, n);
+	if (n <= 0)
+		c->stdin_closed = 1;
+	else
+		server_client_wait_fd(&c->stdin_event, c->stdin_poll);
+	c->stdin_callback(c, c->stdin_closed, c->stdin_callback_data);
+}
+
+/* Start reading client stdin. */
+void
+server_client_pull_stdin(struct client *c)
+{
+	if (c->stdin_fd == -1)
+		proc_send(c->peer, MSG_STDIN, -1, NULL, 0);
+	else if (!c->stdin_closed)
+		server_client_wait_fd(&c->stdin_event, c->stdin_poll);
+}
+
+/* Event callback to write to client stdout. */
+static void
+server_client_stdout_event(__unused int fd, __unused short events, void *arg)
+{
+	struct client	*c = arg;
+
+	server_client_push_stdout(c);
+	server_client_check_stdout(c);
+}
+
+/*
+ * Ask the stdout callback for more once everything so far has been written
+ * or, when stdout is sent in messages, only a few are waiting to be sent.
+ */
+static void
+server_client_check_stdout(struct client *c)
+{
+	if (c->stdout_callback == NULL)
+		return;
+	if (EVBUFFER_LENGTH(c->stdout_data) != 0)
+		return;
+	if (c->stdout_fd == -1 && proc_queued(c->peer) > SERVER_CLIENT_QUEUED)
+		return;
+	c->stdout_callback(c, 0, c->stdout_callback_data);
+}
+
+/* Write stdout directly to the client's file descriptor. */
+static void
+server_client_write_stdout(struct client *c)
+{
+	size_t	left;
+	ssize_t	n;
+
+	while ((left = EVBUFFER_LENGTH(c->stdout_data)) != 0) {
+		n = write(c->stdout_fd, EVBUFFER_DATA(c->stdout_data), left);
+		if (n == -1) {
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN)
+				break;
+			log_debug("%s: client %p, write failed: %s", __func__,
+			    c, strerror(errno));
+			evbuffer_drain(c->stdout_data, left);
+			break;
+		}
+		evbuffer_drain(c->stdout_data, n);
+		log_debug("%s: client %p, wrote %zd, left %zu", __func__, c,
+		    n, left - n);
+	}
+	if (EVBUFFER_LENGTH(c->stdout_data) != 0 || c->stdout_callback != NULL)
+		server_client_wait_fd(&c->stdout_event, c->stdout_poll);
+}
+
 /* Event callback to push more stdout data if any left. */
 static void
 server_client_stdout_cb(__unused int fd, __unused short events, void *arg)
@@ -2023,6 +2208,11 @@ server_client_push_stdout(struct client *c)
 	struct msg_stdout_data data;
 	size_t		       sent, left;
 
+	if (c->stdout_fd != -1) {
+		server_client_write_stdout(c);
+		return;
+	}
+
 	left = EVBUFFER_LENGTH(c->stdout_data);
 	while (left != 0) {
 		sent = left;
@@ -2046,6 +2236,20 @@ server_client_push_stdout(struct client *c)
 	}
 }
 
+/*
+ * Stop writing stdout directly and send it in messages instead. The
+ * descriptor is put back to blocking first, because the client will be
+ * writing to it.
+ */
+static void
+server_client_close_stdout(struct client *c)
+{
+	event_del(&c->stdout_event);
+	setblocking(c->stdout_fd, 1);
+	close(c->stdout_fd);
+	c->stdout_fd = -1;
+}
+
 /* Event callback to push more stderr data if any left. */
 static void
 server_client_stderr_cb(__unused int fd, __unused short events, void *arg)
@@ -2069,6 +2273,17 @@ server_client_push_stderr(struct client *c)
 		return;
 	}
 
+	/*
+	 * Stderr is always sent in messages, so once there is any, stdout is
+	 * too. Otherwise, if they are the same file, stdout written after
+	 * this could get there before the client has written the stderr. Any
+	 * stdout still waiting to be written goes first.
+	 */
+	if (c->stdout_fd != -1 && EVBUFFER_LENGTH(c->stderr_data) != 0) {
+		server_client_close_stdout(c);
+		server_client_push_stdout(c);
+	}
+
 	left = EVBUFFER_LENGTH(c->stderr_data);
 	while (left != 0) {
 		sent = left;
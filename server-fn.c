@@ -465,7 +465,7 @@ server_set_stdin_callback(struct client *c, void (*cb)(struct client *, int,
 	if (c->stdin_closed)
 		c->stdin_callback(c, 1, c->stdin_callback_data);
 
-	proc_send(c->peer, MSG_STDIN, -1, NULL, 0);
+	server_client_pull_stdin(c);
 
 	return (0);
 }
@@ -212,7 +212,15 @@ server_start(struct tmuxproc *client, struct event_base *base, int lockfd,
 	server_add_accept(0);
 	proc_loop(server_proc, server_loop);
 
+	/*
+	 * Stop listening straight away so a new client gets ECONNREFUSED and
+	 * starts a new server rather than connecting to one that is exiting.
+	 */
+	if (server_fd != -1)
+		close(server_fd);
+
 	job_kill_all();
+	pane_log_flush_all();
 	status_prompt_save_history();
 
 	exit(0);
@@ -259,6 +267,16 @@ server_loop(void)
 	if (job_still_running())
 		return (0);
 
+	/*
+	 * A client may have connected since the event loop last checked the
+	 * socket. Accept it now rather than exit and leave it stranded.
+	 */
+	if (server_fd != -1 && !server_exit) {
+		server_accept(server_fd, EV_READ, NULL);
+		if (!TAILQ_EMPTY(&clients))
+			return (0);
+	}
+
 	return (1);
 }
 
@@ -389,6 +407,16 @@ server_signal(int sig)
 	case SIGTERM:
 		server_exit = 1;
 		server_send_exit();
+
+		/*
+		 * New clients would only be turned away now, so stop listening
+		 * and let them start a new server instead.
+		 */
+		if (server_fd != -1) {
+			event_del(&server_ev_accept);
+			close(server_fd);
+			server_fd = -1;
+		}
 		break;
 	case SIGCHLD:
 		server_child_signal();
@@ -28,6 +28,7 @@
 
 struct sessions		sessions;
 static u_int		next_session_id;
+static struct session  *session_latest;
 struct session_groups	session_groups = RB_INITIALIZER(&session_groups);
 
 static void	session_free(int, short, void *);
@@ -37,6 +38,8 @@ static void	session_lock_timer(int, short, void *);
 static struct winlink *session_next_alert(struct winlink *);
 static struct winlink *session_previous_alert(struct winlink *);
 
+static int	session_name_index_cmp(const void *, const void *);
+
 static void	session_group_remove(struct session *);
 static void	session_group_synchronize1(struct session *, struct session *);
 
@@ -109,6 +112,82 @@ session_find_by_id(u_int id)
 	return (NULL);
 }
 
+/*
+ * Find the session with the most recent activity. This is cached when there is
+ * a single most recent session, otherwise the first by name is returned.
+ */
+struct session *
+session_find_latest(void)
+{
+	struct session	*s, *s_latest = NULL;
+	int		 tie = 0;
+
+	if (session_latest != NULL)
+		return (session_latest);
+
+	RB_FOREACH(s, sessions, &sessions) {
+		if (s_latest == NULL || timercmp(&s->activity_time,
+		    &s_latest->activity_time, >)) {
+			s_latest = s;
+			tie = 0;
+		} else if (timercmp(&s->activity_time, &s_latest->activity_time,
+		    ==))
+			tie = 1;
+	}
+	if (!tie)
+		session_latest = s_latest;
+	return (s_latest);
+}
+
+/* Compare winlinks by window name. */
+static int
+session_name_index_cmp(const void *a, const void *b)
+{
+	struct winlink	*wl1 = *(struct winlink **)a;
+	struct winlink	*wl2 = *(struct winlink **)b;
+
+	return (strcmp(wl1->window->name, wl2->window->name));
+}
+
+/*
+ * Get the winlinks in a session sorted by window name. The index is rebuilt if
+ * a window in the session has been renamed or a winlink added or removed since
+ * it was last built.
+ */
+struct winlink **
+session_name_index(struct session *s, u_int *size)
+{
+	struct winlink	*wl;
+	u_int		 n;
+
+	if (!s->name_index_valid) {
+		free(s->name_index);
+		s->name_index = NULL;
+
+		n = 0;
+		RB_FOREACH(wl, winlinks, &s->windows) {
+			if (wl->window != NULL && wl->window->name != NULL)
+				n++;
+		}
+		if (n != 0) {
+			s->name_index = xreallocarray(NULL, n, sizeof *wl);
+			n = 0;
+			RB_FOREACH(wl, winlinks, &s->windows) {
+				if (wl->window != NULL &&
+				    wl->window->name != NULL)
+					s->name_index[n++] = wl;
+			}
+			qsort(s->name_index, n, sizeof *s->name_index,
+			    session_name_index_cmp);
+		}
+		s->name_index_size = n;
+		s->name_index_valid = 1;
+	}
+
+	*size = s->name_index_size;
+	return (s->name_index);
+}
+
 /* Create a new session. */
 struct session *
 session_create(const char *prefix, const char *name, const char *cwd,
@@ -193,6 +272,7 @@ session_free(__unused int fd, __unused short events, void *arg)
 		environ_free(s->environ);
 		options_free(s->options);
 
+		free(s->name_index);
 		free(s->name);
 		free(s);
 	}
@@ -208,6 +288,8 @@ session_destroy(struct session *s, int notify, const char *from)
 	s->curw = NULL;
 
 	RB_REMOVE(sessions, &sessions, s);
+	if (s == session_latest)
+		session_latest = NULL;
 	if (notify)
 		notify_session("session-closed", s);
 
@@ -267,6 +349,18 @@ session_update_activity(struct session *s, struct timeval *from)
 	else
 		memcpy(&s->activity_time, from, sizeof s->activity_time);
 
+	if (session_latest != NULL) {
+		if (s == session_latest) {
+			if (timercmp(&s->activity_time, last, <))
+				session_latest = NULL;
+		} else if (timercmp(&s->activity_time,
+		    &session_latest->activity_time, >))
+			session_latest = s;
+		else if (timercmp(&s->activity_time,
+		    &session_latest->activity_time, ==))
+			session_latest = NULL;
+	}
+
 	log_debug("session $%u %s activity %lld.%06d (last %lld.%06d)", s->id,
 	    s->name, (long long)s->activity_time.tv_sec,
 	    (int)s->activity_time.tv_usec, (long long)last->tv_sec,
@@ -182,6 +182,7 @@ spawn_window(struct spawn_context *sc, char **cause)
 			options_set_number(w->options, "automatic-rename", 0);
 		} else
 			w->name = xstrdup(default_window_name(w));
+		s->name_index_valid = 0;
 	}
 
 	/* Switch to the new window if required. */
@@ -245,6 +246,10 @@ spawn_pane(struct spawn_context *sc, char **cause)
 		new_wp = window_add_pane(w, sc->wp0, hlimit, sc->flags);
 		layout_assign_pane(sc->lc, new_wp);
 	}
+	if (~sc->flags & SPAWN_RESPAWN) {
+		grid_cold_enable(new_wp->base.grid,
+		    options_get_number(s->options, "history-cold-limit"));
+	}
 
 	/*
 	 * Now we have a pane with nothing running in it ready for the new
@@ -429,6 +434,7 @@ complete:
 
 	sigprocmask(SIG_SETMASK, &oldset, NULL);
 	window_pane_set_event(new_wp);
+	pane_log_update(new_wp);
 
 	if (sc->flags & SPAWN_RESPAWN)
 		return (new_wp);
@@ -309,6 +309,8 @@ status_free(struct client *c)
 		free(sl->active);
 	}
 	screen_free(&sl->screen);
+	if (sl->drawn != NULL)
+		grid_destroy(sl->drawn);
 }
 
 /* Draw status line for client. */
@@ -47,6 +47,7 @@ struct cmdq_list;
 struct environ;
 struct format_job_tree;
 struct format_tree;
+struct grid_cold;
 struct input_ctx;
 struct job;
 struct mode_tree_data;
@@ -54,6 +55,7 @@ struct mouse_event;
 struct options;
 struct options_entry;
 struct options_array_item;
+struct pane_log;
 struct session;
 struct tmuxpeer;
 struct tmuxproc;
@@ -426,6 +428,8 @@ enum tty_code_code {
 	TTYC_RMACS,
 	TTYC_RMCUP,
 	TTYC_RMKX,
+	TTYC_RMSO,
+	TTYC_RMUL,
 	TTYC_SE,
 	TTYC_SETAB,
 	TTYC_SETAF,
@@ -464,6 +468,7 @@ enum msgtype {
 	MSG_IDENTIFY_DONE,
 	MSG_IDENTIFY_CLIENTPID,
 	MSG_IDENTIFY_CWD,
+	MSG_IDENTIFY_STDOUT,
 
 	MSG_COMMAND = 200,
 	MSG_DETACH,
@@ -560,6 +565,10 @@ enum utf8_state {
 /* Special colours. */
 #define COLOUR_DEFAULT(c) ((c) == 8 || (c) == 9)
 
+/* Ways of approximating RGB colours. */
+#define COLOUR_APPROXIMATE_NEAREST 0
+#define COLOUR_APPROXIMATE_PERCEPTUAL 1
+
 /* Grid attributes. Anything above 0xff is stored in an extended cell. */
 #define GRID_ATTR_BRIGHT 0x1
 #define GRID_ATTR_DIM 0x2
@@ -597,6 +606,8 @@ enum utf8_state {
 #define GRID_LINE_WRAPPED 0x1
 #define GRID_LINE_EXTENDED 0x2
 #define GRID_LINE_DEAD 0x4
+#define GRID_LINE_COLD 0x8
+#define GRID_LINE_ROUNDED 0x10
 
 /* Grid cell data. */
 struct grid_cell {
@@ -643,8 +654,11 @@ struct grid {
 	u_int			 hscrolled;
 	u_int			 hsize;
 	u_int			 hlimit;
+	u_int			 htrimmed;
+	unsigned long long	 hbytes;
 
 	struct grid_line	*linedata;
+	struct grid_cold	*cold;
 };
 
 /* Style alignment. */
@@ -880,6 +894,14 @@ struct window_pane {
 	int		 pipe_fd;
 	struct bufferevent *pipe_event;
 	size_t		 pipe_off;
+	int		 pipe_blocked;
+	int		 pipe_spill_fd;
+	off_t		 pipe_spill_off;
+	off_t		 pipe_spill_size;
+	u_long		 pipe_dropped;
+
+	struct pane_log	*log;
+	u_int		 capturing;
 
 	struct screen	*screen;
 	struct screen	 base;
@@ -929,6 +951,13 @@ struct window {
 	u_int		 sx;
 	u_int		 sy;
 
+	u_char		*border_map;
+	u_int		 border_sx;
+	u_int		 border_sy;
+	int		 border_status;
+	struct window_pane *border_active;
+	struct window_pane *border_marked;
+
 	int		 flags;
 #define WINDOW_BELL 0x1
 #define WINDOW_ACTIVITY 0x2
@@ -978,6 +1007,11 @@ TAILQ_HEAD(winlink_stack, winlink);
 #define PANE_STATUS_TOP 1
 #define PANE_STATUS_BOTTOM 2
 
+/* Pipe pane policy option. */
+#define PIPE_PANE_BLOCK 0
+#define PIPE_PANE_DROP 1
+#define PIPE_PANE_SPILL 2
+
 /* Layout direction. */
 enum layout_type {
 	LAYOUT_LEFTRIGHT,
@@ -1040,6 +1074,10 @@ struct session {
 	struct winlink_stack lastw;
 	struct winlinks	 windows;
 
+	struct winlink	**name_index;
+	u_int		 name_index_size;
+	int		 name_index_valid;
+
 	int		 statusat;
 	u_int		 statuslines;
 
@@ -1125,6 +1163,20 @@ struct tty_key {
 	struct tty_key	*next;
 };
 
+/*
+ * Compiled key table state. Each state holds the key if a sequence ends here
+ * and a row of transitions for bytes lo to hi, starting at base in the
+ * tty's key_trans array. A transition of zero means no match, since the root
+ * state is never a target.
+ */
+struct tty_key_state {
+	key_code	 key;
+
+	u_char		 lo;
+	u_char		 hi;
+	u_int		 base;
+};
+
 struct tty_code;
 struct tty_term {
 	char		*name;
@@ -1136,6 +1188,7 @@ struct tty_term {
 
 #define TERM_256COLOURS 0x1
 #define TERM_EARLYWRAP 0x2
+#define TERM_SGROFF 0x4
 	int		 flags;
 
 	LIST_ENTRY(tty_term) entry;
@@ -1171,7 +1224,11 @@ struct tty {
 	struct event	 event_in;
 	struct evbuffer	*in;
 	struct event	 event_out;
-	struct evbuffer	*out;
+	char		*out;		/* output buffer */
+	size_t		 out_off;	/* start of unwritten data */
+	size_t		 out_len;	/* end of data */
+	size_t		 out_size;	/* allocated size */
+	struct timeval	 out_time;	/* when buffer became non-empty */
 	struct event	 timer;
 	size_t		 discarded;
 
@@ -1182,6 +1239,10 @@ struct tty {
 	int		 last_wp;
 	struct grid_cell last_cell;
 
+	char		 sgr[64];	/* pending SGR parameters */
+	size_t		 sgr_len;
+	u_int		 sgr_count;
+
 #define TTY_NOCURSOR 0x1
 #define TTY_FREEZE 0x2
 #define TTY_TIMER 0x4
@@ -1190,6 +1251,7 @@ struct tty {
 #define TTY_OPENED 0x20
 #define TTY_FOCUS 0x40
 #define TTY_BLOCK 0x80
+#define TTY_SGR 0x100
 	int		 flags;
 
 	struct tty_term	*term;
@@ -1215,7 +1277,10 @@ struct tty {
 			    struct mouse_event *);
 
 	struct event	 key_timer;
-	struct tty_key	*key_tree;
+	struct tty_key_state *key_states;
+	u_int		 key_nstates;
+	u_int		*key_trans;
+	u_int		 key_ntrans;
 };
 #define TTY_TYPES \
 	{ "VT100", "VT101", "VT102", "VT220", "VT320", "VT420", "Unknown" }
@@ -1229,6 +1294,7 @@ struct tty_ctx {
 
 	u_int		 num;
 	void		*ptr;
+	size_t		 ptrlen;
 
 	/*
 	 * Cursor and region position before the screen was updated - this is
@@ -1453,6 +1519,8 @@ struct status_line {
 	struct screen		*active;
 	int			 references;
 
+	struct grid		*drawn;
+
 	struct grid_cell	 style;
 	struct status_line_entry entries[STATUS_LINES_LIMIT];
 };
@@ -1489,12 +1557,22 @@ struct client {
 	size_t		 written;
 	size_t		 discarded;
 	size_t		 redraw;
+	u_int		 writes;
+	u_int		 write_latency;
 
 	void		(*stdin_callback)(struct client *, int, void *);
 	void		*stdin_callback_data;
 	struct evbuffer	*stdin_data;
 	int		 stdin_closed;
+	int		 stdin_fd;
+	int		 stdin_poll;
+	struct event	 stdin_event;
+	void		(*stdout_callback)(struct client *, int, void *);
+	void		*stdout_callback_data;
 	struct evbuffer	*stdout_data;
+	int		 stdout_fd;
+	int		 stdout_poll;
+	struct event	 stdout_event;
 	struct evbuffer	*stderr_data;
 
 	struct event	 repeat_timer;
@@ -1531,6 +1609,7 @@ struct client {
 #define CLIENT_REDRAWSTATUSALWAYS 0x1000000
 #define CLIENT_REDRAWOVERLAY 0x2000000
 #define CLIENT_CONTROL_NOOUTPUT 0x4000000
+#define CLIENT_BATCH 0x8000000
 #define CLIENT_ALLREDRAWFLAGS		\
 	(CLIENT_REDRAWWINDOW|		\
 	 CLIENT_REDRAWSTATUS|		\
@@ -1588,6 +1667,7 @@ TAILQ_HEAD(clients, client);
 struct key_binding {
 	key_code		 key;
 	struct cmd_list		*cmdlist;
+	const char		*cmdstring;
 
 	int			 flags;
 #define KEY_BINDING_REPEAT 0x1
@@ -1718,6 +1798,7 @@ const char	*find_home(void);
 /* proc.c */
 struct imsg;
 int	proc_send(struct tmuxpeer *, enum msgtype, int, const void *, size_t);
+u_int	proc_queued(struct tmuxpeer *);
 struct tmuxproc *proc_start(const char *);
 void	proc_loop(struct tmuxproc *, int (*)(void));
 void	proc_exit(struct tmuxproc *);
@@ -1862,6 +1943,8 @@ typedef void (*job_update_cb) (struct job *);
 typedef void (*job_complete_cb) (struct job *);
 typedef void (*job_free_cb) (void *);
 #define JOB_NOWAIT 0x1
+pid_t		 job_fork(const char *, const char *, struct environ *,
+		     int, int, sigset_t *);
 struct job	*job_run(const char *, struct session *, const char *,
 		     job_update_cb, job_complete_cb, job_free_cb, void *, int);
 void		 job_free(struct job *);
@@ -1924,6 +2007,8 @@ void	tty_draw_line(struct tty *, struct window_pane *, struct screen *,
 	    u_int, u_int, u_int, u_int, u_int);
 int	tty_open(struct tty *, char **);
 void	tty_close(struct tty *);
+size_t	tty_output_pending(struct tty *);
+void	tty_flush(struct tty *);
 void	tty_free(struct tty *);
 void	tty_set_type(struct tty *, int);
 void	tty_write(void (*)(struct tty *, const struct tty_ctx *),
@@ -2090,6 +2175,7 @@ struct key_table *key_bindings_first_table(void);
 struct key_table *key_bindings_next_table(struct key_table *);
 void	 key_bindings_unref_table(struct key_table *);
 struct key_binding *key_bindings_get(struct key_table *, key_code);
+struct cmd_list *key_bindings_get_cmdlist(struct key_binding *);
 struct key_binding *key_bindings_first(struct key_table *);
 struct key_binding *key_bindings_next(struct key_table *, struct key_binding *);
 void	 key_bindings_add(const char *, key_code, int, struct cmd_list *);
@@ -2139,6 +2225,7 @@ void	 server_client_suspend(struct client *);
 void	 server_client_detach(struct client *, enum msgtype);
 void	 server_client_exec(struct client *, const char *);
 void	 server_client_loop(void);
+void	 server_client_pull_stdin(struct client *);
 void	 server_client_push_stdout(struct client *);
 void	 server_client_push_stderr(struct client *);
 void printflike(2, 3) server_client_add_message(struct client *, const char *,
@@ -2212,10 +2299,12 @@ void	 input_key(struct window_pane *, key_code, struct mouse_event *);
 
 /* xterm-keys.c */
 char	*xterm_keys_lookup(key_code);
-int	 xterm_keys_find(const char *, size_t, size_t *, key_code *);
+void	 xterm_keys_expand(void (*)(const char *, key_code, void *), void *);
 
 /* colour.c */
 int	 colour_find_rgb(u_char, u_char, u_char);
+void	 colour_set_approximation(int);
+int	 colour_RGBto256(int);
 int	 colour_join_rgb(u_char, u_char, u_char);
 void	 colour_split_rgb(int, u_char *, u_char *, u_char *);
 const char *colour_tostring(int);
@@ -2229,6 +2318,7 @@ int	 attributes_fromstring(const char *);
 
 /* grid.c */
 extern const struct grid_cell grid_default_cell;
+extern const struct grid_cell grid_padding_cell;
 int	 grid_cells_equal(const struct grid_cell *, const struct grid_cell *);
 struct grid *grid_create(u_int, u_int, u_int);
 void	 grid_destroy(struct grid *);
@@ -2237,11 +2327,16 @@ void	 grid_collect_history(struct grid *);
 void	 grid_scroll_history(struct grid *, u_int);
 void	 grid_scroll_history_region(struct grid *, u_int, u_int, u_int);
 void	 grid_clear_history(struct grid *);
+unsigned long long grid_trim_history_bytes(struct grid *, unsigned long long);
+void	 grid_add_history(struct grid *, u_int);
+void	 grid_remove_history(struct grid *, u_int);
+unsigned long long grid_history_bytes(struct grid *);
+unsigned long long grid_history_total_bytes(void);
 const struct grid_line *grid_peek_line(struct grid *, u_int);
 void	 grid_get_cell(struct grid *, u_int, u_int, struct grid_cell *);
 void	 grid_set_cell(struct grid *, u_int, u_int, const struct grid_cell *);
 void	 grid_set_cells(struct grid *, u_int, u_int, const struct grid_cell *,
-	     const char *, size_t);
+	     const char *, size_t, const u_char *);
 struct grid_line *grid_get_line(struct grid *, u_int);
 void	 grid_adjust_lines(struct grid *, u_int);
 void	 grid_clear(struct grid *, u_int, u_int, u_int, u_int, u_int);
@@ -2256,13 +2351,25 @@ void	 grid_reflow(struct grid *, u_int);
 void	 grid_wrap_position(struct grid *, u_int, u_int, u_int *, u_int *);
 void	 grid_unwrap_position(struct grid *, u_int *, u_int *, u_int, u_int);
 u_int	 grid_line_length(struct grid *, u_int);
+int	 grid_save(struct grid *, FILE *);
+int	 grid_load(struct grid *, const void *, size_t, char **);
+
+/* grid-cold.c */
+void	 grid_cold_enable(struct grid *, u_int);
+void	 grid_cold_free(struct grid *);
+void	 grid_cold_release(struct grid *, struct grid_line *);
+void	 grid_cold_thaw(struct grid *, struct grid_line *);
+void	 grid_cold_scrolled(struct grid *);
+void	 grid_cold_sweep(struct grid *);
+unsigned long long grid_cold_bytes(struct grid *);
+unsigned long long grid_cold_total_bytes(void);
 
 /* grid-view.c */
 void	 grid_view_get_cell(struct grid *, u_int, u_int, struct grid_cell *);
 void	 grid_view_set_cell(struct grid *, u_int, u_int,
 	     const struct grid_cell *);
 void	 grid_view_set_cells(struct grid *, u_int, u_int,
-	     const struct grid_cell *, const char *, size_t);
+	     const struct grid_cell *, const char *, size_t, const u_char *);
 void	 grid_view_clear_history(struct grid *, u_int);
 void	 grid_view_clear(struct grid *, u_int, u_int, u_int, u_int, u_int);
 void	 grid_view_scroll_region_up(struct grid *, u_int, u_int, u_int);
@@ -2338,6 +2445,7 @@ void	 screen_write_rawstring(struct screen_write_ctx *, u_char *, u_int);
 /* screen-redraw.c */
 void	 screen_redraw_screen(struct client *);
 void	 screen_redraw_pane(struct client *, struct window_pane *);
+void	 screen_redraw_invalidate(struct window *);
 
 /* screen.c */
 void	 screen_init(struct screen *, u_int, u_int, u_int);
@@ -2415,6 +2523,13 @@ void		 window_destroy_panes(struct window *);
 struct window_pane *window_pane_find_by_id_str(const char *);
 struct window_pane *window_pane_find_by_id(u_int);
 int		 window_pane_destroy_ready(struct window_pane *);
+void		 window_collect_history(void);
+void		 window_collect_history_reset(void);
+void		 window_pane_pipe_close(struct window_pane *);
+void		 window_pane_pipe_write(struct window_pane *, const void *,
+		     size_t);
+void		 window_pane_pipe_written(struct window_pane *);
+size_t		 window_pane_pipe_backlog(struct window_pane *);
 void		 window_pane_resize(struct window_pane *, u_int, u_int);
 void		 window_pane_alternate_on(struct window_pane *,
 		     struct grid_cell *, int);
@@ -2544,6 +2659,12 @@ void		 window_copy_vadd(struct window_pane *, const char *, va_list);
 void		 window_copy_pageup(struct window_pane *, int);
 void		 window_copy_start_drag(struct client *, struct mouse_event *);
 
+/* pane-log.c */
+void	 pane_log_close(struct window_pane *);
+void	 pane_log_update(struct window_pane *);
+void	 pane_log_write(struct window_pane *, const void *, size_t);
+void	 pane_log_flush_all(void);
+
 /* names.c */
 void	 check_window_name(struct window *);
 char	*default_window_name(struct window *);
@@ -2577,6 +2698,8 @@ int		 session_alive(struct session *);
 struct session	*session_find(const char *);
 struct session	*session_find_by_id_str(const char *);
 struct session	*session_find_by_id(u_int);
+struct session	*session_find_latest(void);
+struct winlink **session_name_index(struct session *, u_int *);
 struct session	*session_create(const char *, const char *, const char *,
 		     struct environ *, struct options *, struct termios *);
 void		 session_destroy(struct session *, int,  const char *);
@@ -2610,8 +2733,11 @@ void		 session_renumber_windows(struct session *);
 /* utf8.c */
 void		 utf8_set(struct utf8_data *, u_char);
 void		 utf8_copy(struct utf8_data *, const struct utf8_data *);
+u_int		 utf8_size(u_char);
 enum utf8_state	 utf8_open(struct utf8_data *, u_char);
 enum utf8_state	 utf8_append(struct utf8_data *, u_char);
+enum utf8_state	 utf8_decode(struct utf8_data *, const u_char *, size_t,
+		     size_t *);
 enum utf8_state	 utf8_combine(const struct utf8_data *, wchar_t *);
 enum utf8_state	 utf8_split(wchar_t, struct utf8_data *);
 int		 utf8_isvalid(const char *);
@@ -2626,6 +2752,11 @@ u_int		 utf8_cstrwidth(const char *);
 char		*utf8_padcstr(const char *, u_int);
 int		 utf8_cstrhas(const char *, const struct utf8_data *);
 
+/* utf8-width.c */
+#define UTF8_WIDTH_UNKNOWN 3
+extern const u_char utf8_width_index[];
+extern const u_char utf8_width_blocks[][64];
+
 /* osdep-*.c */
 char		*osdep_get_name(int, char *);
 char		*osdep_get_cwd(int);
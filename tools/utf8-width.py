@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+#
+# Generate utf8-width.c, the table of Unicode character widths used by
+# utf8_width, from the Unicode data built into Python:
+#
+#	python3 tools/utf8-width.py >utf8-width.c
+#
+# Each character is given one of four classes: zero width (combining marks
+# and format characters), one cell, two cells (East Asian wide and fullwidth)
+# or unknown (controls, surrogates and unassigned code points). The table is in
+# two levels: the first is indexed by the top bits of the code point and gives
+# a block of 256 characters in the second, each stored in two bits.
+
+import unicodedata
+
+WIDE_UNASSIGNED = (
+    (0x3400, 0x4dbf), (0x4e00, 0x9fff), (0xf900, 0xfaff),
+    (0x20000, 0x2fffd), (0x30000, 0x3fffd)
+)
+PREPENDED = (
+    0x600, 0x601, 0x602, 0x603, 0x604, 0x605, 0x6dd, 0x70f, 0x890, 0x891,
+    0x8e2, 0x110bd, 0x110cd
+)
+
+
+def width(cp):
+    c = chr(cp)
+    category = unicodedata.category(c)
+    if category == 'Cn':
+        for first, last in WIDE_UNASSIGNED:
+            if cp >= first and cp <= last:
+                return 2
+        return 3
+    if category in ('Cc', 'Cs'):
+        return 3
+    if category in ('Mn', 'Me', 'Cf'):
+        if cp == 0xad or cp in PREPENDED:
+            return 1
+        return 0
+    if (cp >= 0x1160 and cp <= 0x11ff) or (cp >= 0xd7b0 and cp <= 0xd7ff):
+        return 0
+    if unicodedata.east_asian_width(c) in ('W', 'F'):
+        return 2
+    return 1
+
+
+blocks = []
+index = []
+for first in range(0, 0x110000, 256):
+    block = bytearray(64)
+    for cp in range(first, first + 256):
+        block[(cp & 0xff) >> 2] |= width(cp) << ((cp & 3) * 2)
+    block = bytes(block)
+    if block not in blocks:
+        blocks.append(block)
+    index.append(blocks.index(block))
+if len(blocks) > 256:
+    raise SystemExit('too many blocks')
+
+print('/* $OpenBSD$ */')
+print('')
+print('/*')
+print(' * Generated by tools/utf8-width.py from Unicode %s. Do not edit.' %
+      unicodedata.unidata_version)
+print(' */')
+print('')
+print('#include <sys/types.h>')
+print('')
+print('#include "tmux.h"')
+print('')
+print('const u_char utf8_width_index[%d] = {' % len(index))
+for i in range(0, len(index), 12):
+    print('\t' + ' '.join('%3d,' % x for x in index[i:i + 12]))
+print('};')
+print('')
+print('const u_char utf8_width_blocks[%d][64] = {' % len(blocks))
+for block in blocks:
+    print('\t{')
+    for i in range(0, 64, 8):
+        print('\t\t' + ' '.join('0x%02x,' % x for x in block[i:i + 8]))
+    print('\t},')
+print('};')
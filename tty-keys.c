@@ -33,16 +33,20 @@
 /*
  * Handle keys input from the outside terminal. tty_default_*_keys[] are a base
  * table of supported keys which are looked up in terminfo(5) and translated
- * into a ternary tree.
+ * into a ternary tree. This is then compiled together with the xterm(1) keys
+ * into a flat table of states so a key can be found without recursion.
  */
 
 static void	tty_keys_add1(struct tty_key **, const char *, key_code);
-static void	tty_keys_add(struct tty *, const char *, key_code);
+static void	tty_keys_add(struct tty_key **, const char *, key_code);
+static void	tty_keys_add_xterm(const char *, key_code, void *);
 static void	tty_keys_free1(struct tty_key *);
-static struct tty_key *tty_keys_find1(struct tty_key *, const char *, size_t,
-		    size_t *);
-static struct tty_key *tty_keys_find(struct tty *, const char *, size_t,
-		    size_t *);
+static u_int	tty_keys_count(struct tty_key *);
+static void	tty_keys_collect(struct tty_key *, struct tty_key ***,
+		    u_int *);
+static u_int	tty_keys_compile(struct tty *, struct tty_key *, key_code);
+static int	tty_keys_find(struct tty *, const char *, size_t, size_t *,
+		    key_code *);
 static int	tty_keys_next1(struct tty *, const char *, size_t, key_code *,
 		    size_t *, int);
 static void	tty_keys_callback(int, short, void *);
@@ -339,20 +343,18 @@ static const struct tty_default_key_code tty_default_code_keys[] = {
 
 /* Add key to tree. */
 static void
-tty_keys_add(struct tty *tty, const char *s, key_code key)
+tty_keys_add(struct tty_key **tree, const char *s, key_code key)
 {
-	struct tty_key	*tk;
-	size_t		 size;
-	const char     	*keystr;
+	log_debug("add key %s: 0x%llx (%s)", s, key,
+	    key_string_lookup_key(key));
+	tty_keys_add1(tree, s, key);
+}
 
-	keystr = key_string_lookup_key(key);
-	if ((tk = tty_keys_find(tty, s, strlen(s), &size)) == NULL) {
-		log_debug("new key %s: 0x%llx (%s)", s, key, keystr);
-		tty_keys_add1(&tty->key_tree, s, key);
-	} else {
-		log_debug("replacing key %s: 0x%llx (%s)", s, key, keystr);
-		tk->key = key;
-	}
+/* Add an xterm(1) key to the tree. */
+static void
+tty_keys_add_xterm(const char *s, key_code key, void *data)
+{
+	tty_keys_add1(data, s, key);
 }
 
 /* Add next node to the tree. */
@@ -393,7 +395,78 @@ tty_keys_add1(struct tty_key **tkp, const char *s, key_code key)
 	tty_keys_add1(tkp, s, key);
 }
 
-/* Initialise a key tree from the table. */
+/* Count the nodes in a tree. */
+static u_int
+tty_keys_count(struct tty_key *tk)
+{
+	if (tk == NULL)
+		return (0);
+	return (1 + tty_keys_count(tk->left) + tty_keys_count(tk->right) +
+	    tty_keys_count(tk->next));
+}
+
+/* Collect the nodes at one level of the tree. */
+static void
+tty_keys_collect(struct tty_key *tk, struct tty_key ***list, u_int *n)
+{
+	if (tk == NULL)
+		return;
+	tty_keys_collect(tk->left, list, n);
+	*list = xreallocarray(*list, (*n) + 1, sizeof **list);
+	(*list)[(*n)++] = tk;
+	tty_keys_collect(tk->right, list, n);
+}
+
+/* Compile a state and the states following it, returning its index. */
+static u_int
+tty_keys_compile(struct tty *tty, struct tty_key *tk, key_code key)
+{
+	struct tty_key_state	*ts;
+	struct tty_key		**list = NULL;
+	u_int			  state, base, target, n = 0, i;
+	u_char			  ch, lo, hi;
+
+	state = tty->key_nstates++;
+	ts = &tty->key_states[state];
+	ts->key = key;
+	ts->lo = 1;
+	ts->hi = 0;
+	ts->base = 0;
+
+	tty_keys_collect(tk, &list, &n);
+	if (n == 0)
+		return (state);
+
+	lo = hi = list[0]->ch;
+	for (i = 1; i < n; i++) {
+		ch = list[i]->ch;
+		if (ch < lo)
+			lo = ch;
+		if (ch > hi)
+			hi = ch;
+	}
+	base = tty->key_ntrans;
+	tty->key_ntrans += (hi - lo) + 1;
+	tty->key_trans = xreallocarray(tty->key_trans, tty->key_ntrans,
+	    sizeof *tty->key_trans);
+	memset(&tty->key_trans[base], 0, ((hi - lo) + 1) * sizeof
+	    *tty->key_trans);
+
+	ts->lo = lo;
+	ts->hi = hi;
+	ts->base = base;
+
+	for (i = 0; i < n; i++) {
+		target = tty_keys_compile(tty, list[i]->next, list[i]->key);
+		ch = list[i]->ch;
+		tty->key_trans[base + (ch - lo)] = target;
+	}
+	free(list);
+
+	return (state);
+}
+
+/* Initialise a key table from the tables. */
 void
 tty_keys_build(struct tty *tty)
 {
@@ -404,24 +477,26 @@ tty_keys_build(struct tty *tty)
 	struct options_entry			*o;
 	struct options_array_item		*a;
 	union options_value			*ov;
+	struct tty_key				*tree = NULL;
 
-	if (tty->key_tree != NULL)
-		tty_keys_free(tty);
-	tty->key_tree = NULL;
+	tty_keys_free(tty);
+
+	/* The xterm(1) keys are added first so any others replace them. */
+	xterm_keys_expand(tty_keys_add_xterm, &tree);
 
 	for (i = 0; i < nitems(tty_default_raw_keys); i++) {
 		tdkr = &tty_default_raw_keys[i];
 
 		s = tdkr->string;
 		if (*s != '\0')
-			tty_keys_add(tty, s, tdkr->key);
+			tty_keys_add(&tree, s, tdkr->key);
 	}
 	for (i = 0; i < nitems(tty_default_code_keys); i++) {
 		tdkc = &tty_default_code_keys[i];
 
 		s = tty_term_string(tty->term, tdkc->code);
 		if (*s != '\0')
-			tty_keys_add(tty, s, tdkc->key);
+			tty_keys_add(&tree, s, tdkc->key);
 
 	}
 
@@ -431,17 +506,33 @@ tty_keys_build(struct tty *tty)
 		while (a != NULL) {
 			i = options_array_item_index(a);
 			ov = options_array_item_value(a);
-			tty_keys_add(tty, ov->string, KEYC_USER + i);
+			if (*ov->string != '\0')
+				tty_keys_add(&tree, ov->string, KEYC_USER + i);
 			a = options_array_next(a);
 		}
 	}
+
+	/* Compile the tree into states and discard it. */
+	tty->key_states = xcalloc(tty_keys_count(tree) + 1,
+	    sizeof *tty->key_states);
+	tty_keys_compile(tty, tree, KEYC_UNKNOWN);
+	if (tree != NULL)
+		tty_keys_free1(tree);
+	log_debug("%s: %u key states, %u transitions", __func__,
+	    tty->key_nstates, tty->key_ntrans);
 }
 
-/* Free the entire key tree. */
+/* Free the key table. */
 void
 tty_keys_free(struct tty *tty)
 {
-	tty_keys_free1(tty->key_tree);
+	free(tty->key_states);
+	tty->key_states = NULL;
+	tty->key_nstates = 0;
+
+	free(tty->key_trans);
+	tty->key_trans = NULL;
+	tty->key_ntrans = 0;
 }
 
 /* Free a single key. */
@@ -457,47 +548,47 @@ tty_keys_free1(struct tty_key *tk)
 	free(tk);
 }
 
-/* Lookup a key in the tree. */
-static struct tty_key *
-tty_keys_find(struct tty *tty, const char *buf, size_t len, size_t *size)
-{
-	*size = 0;
-	return (tty_keys_find1(tty->key_tree, buf, len, size));
-}
-
-/* Find the next node. */
-static struct tty_key *
-tty_keys_find1(struct tty_key *tk, const char *buf, size_t len, size_t *size)
+/*
+ * Lookup the longest key at the start of the buffer. Returns 0 if a key was
+ * found, 1 if the buffer could be the start of a longer key (the longest key
+ * found so far, if any, is still returned) and -1 if there is no key.
+ */
+static int
+tty_keys_find(struct tty *tty, const char *buf, size_t len, size_t *size,
+    key_code *key)
 {
-	/* If no data, no match. */
-	if (len == 0)
-		return (NULL);
-
-	/* If the node is NULL, this is the end of the tree. No match. */
-	if (tk == NULL)
-		return (NULL);
+	const struct tty_key_state	*ts;
+	u_int				 state = 0, next;
+	size_t				 pos;
+	u_char				 ch;
 
-	/* Pick the next in the sequence. */
-	if (tk->ch == *buf) {
-		/* Move forward in the string. */
-		buf++; len--;
-		(*size)++;
+	*key = KEYC_UNKNOWN;
+	*size = 0;
+	if (tty->key_states == NULL)
+		return (-1);
 
-		/* At the end of the string, return the current node. */
-		if (len == 0 || (tk->next == NULL && tk->key != KEYC_UNKNOWN))
-			return (tk);
+	for (pos = 0; pos < len; pos++) {
+		ts = &tty->key_states[state];
+		ch = buf[pos];
+		if (ch < ts->lo || ch > ts->hi)
+			break;
+		next = tty->key_trans[ts->base + (ch - ts->lo)];
+		if (next == 0)
+			break;
+		state = next;
 
-		/* Move into the next tree for the following character. */
-		tk = tk->next;
-	} else {
-		if (*buf < tk->ch)
-			tk = tk->left;
-		else if (*buf > tk->ch)
-			tk = tk->right;
+		if (tty->key_states[state].key != KEYC_UNKNOWN) {
+			*key = tty->key_states[state].key;
+			*size = pos + 1;
+		}
 	}
 
-	/* Move to the next in the tree. */
-	return (tty_keys_find1(tk, buf, len, size));
+	ts = &tty->key_states[state];
+	if (pos == len && ts->lo <= ts->hi)
+		return (1);
+	if (*key == KEYC_UNKNOWN)
+		return (-1);
+	return (0);
 }
 
 /* Look up part of the next key. */
@@ -506,7 +597,6 @@ tty_keys_next1(struct tty *tty, const char *buf, size_t len, key_code *key,
     size_t *size, int expired)
 {
 	struct client		*c = tty->client;
-	struct tty_key		*tk, *tk1;
 	struct utf8_data	 ud;
 	enum utf8_state		 more;
 	u_int			 i;
@@ -517,24 +607,14 @@ tty_keys_next1(struct tty *tty, const char *buf, size_t len, key_code *key,
 	    (int)len, buf, expired);
 
 	/* Is this a known key? */
-	tk = tty_keys_find(tty, buf, len, size);
-	if (tk != NULL && tk->key != KEYC_UNKNOWN) {
-		tk1 = tk;
-		do
-			log_debug("%s: keys in list: %#llx", c->name, tk1->key);
-		while ((tk1 = tk1->next) != NULL);
-		if (tk->next != NULL && !expired)
-			return (1);
-		*key = tk->key;
-		return (0);
-	}
-
-	/* Is this an an xterm(1) key? */
-	n = xterm_keys_find(buf, len, size, key);
-	if (n == 0)
-		return (0);
+	n = tty_keys_find(tty, buf, len, size, key);
 	if (n == 1 && !expired)
 		return (1);
+	if (*key != KEYC_UNKNOWN) {
+		log_debug("%s: found key %.*s %#llx", c->name, (int)*size,
+		    buf, *key);
+		return (0);
+	}
 
 	/* Is this valid UTF-8? */
 	more = utf8_open(&ud, (u_char)*buf);
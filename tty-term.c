@@ -32,6 +32,9 @@
 
 static void	 tty_term_override(struct tty_term *, const char *);
 static char	*tty_term_strip(const char *);
+static struct tty_term_op *tty_term_compile(const char *);
+static const char *tty_term_run(const struct tty_term_op *, const char *, int,
+		     int, int);
 
 struct tty_terms tty_terms = LIST_HEAD_INITIALIZER(tty_terms);
 
@@ -42,6 +45,50 @@ enum tty_code_type {
 	TTYCODE_FLAG,
 };
 
+/*
+ * Parameterized strings are compiled into a list of these when the terminal is
+ * loaded, so the common cases do not need to go through tparm(3) and parse the
+ * string each time. Literal text is left in the original string and
+ * referenced by offset and length; jumps are to an op index.
+ */
+enum tty_term_op_type {
+	TTYOP_END = 0,
+	TTYOP_LITERAL,
+	TTYOP_PARAM,
+	TTYOP_CONSTANT,
+	TTYOP_INCREMENT,
+	TTYOP_PRINT,
+	TTYOP_NOT,
+	TTYOP_COMPLEMENT,
+	TTYOP_ADD,
+	TTYOP_SUBTRACT,
+	TTYOP_MULTIPLY,
+	TTYOP_DIVIDE,
+	TTYOP_MODULO,
+	TTYOP_AND,
+	TTYOP_OR,
+	TTYOP_XOR,
+	TTYOP_EQUAL,
+	TTYOP_GREATER,
+	TTYOP_LESS,
+	TTYOP_LOGICAL_AND,
+	TTYOP_LOGICAL_OR,
+	TTYOP_JUMP,
+	TTYOP_JUMP_FALSE,
+};
+
+struct tty_term_op {
+	u_short			type;
+	u_short			length;
+	int			value;
+};
+
+/* Largest possible expanded string and deepest stack for compiled strings. */
+#define TTY_TERM_MAX_OUTPUT 512
+#define TTY_TERM_MAX_STACK 16
+#define TTY_TERM_MAX_NEST 8
+#define TTY_TERM_MAX_JUMPS 16
+
 struct tty_code {
 	enum tty_code_type	type;
 	union {
@@ -49,6 +96,7 @@ struct tty_code {
 		int		number;
 		int		flag;
 	} value;
+	struct tty_term_op     *ops;
 };
 
 struct tty_term_code_entry {
@@ -246,6 +294,8 @@ static const struct tty_term_code_entry tty_term_codes[] = {
 	[TTYC_RMACS] = { TTYCODE_STRING, "rmacs" },
 	[TTYC_RMCUP] = { TTYCODE_STRING, "rmcup" },
 	[TTYC_RMKX] = { TTYCODE_STRING, "rmkx" },
+	[TTYC_RMSO] = { TTYCODE_STRING, "rmso" },
+	[TTYC_RMUL] = { TTYCODE_STRING, "rmul" },
 	[TTYC_SETAB] = { TTYCODE_STRING, "setab" },
 	[TTYC_SETAF] = { TTYCODE_STRING, "setaf" },
 	[TTYC_SETRGBB] = { TTYCODE_STRING, "setrgbb" },
@@ -306,6 +356,313 @@ tty_term_strip(const char *s)
 	return (xstrdup(buf));
 }
 
+/*
+ * Compile a parameterized string. Only the parts of the tparm(3) language that
+ * are used by common terminals are supported (parameters, constants, %i,
+ * plain %d, arithmetic and conditionals); anything else returns NULL and the
+ * string is left to tparm.
+ */
+static struct tty_term_op *
+tty_term_compile(const char *s)
+{
+	struct tty_term_op	*ops;
+	const char		*ptr = s, *start;
+	u_int			 n = 0, nest = 0, i, prints = 0;
+	size_t			 literal = 0;
+	int			 value, params = 0;
+	struct {
+		int		 jump_false;
+		u_int		 jumps[TTY_TERM_MAX_JUMPS];
+		u_int		 njumps;
+	} levels[TTY_TERM_MAX_NEST], *level;
+
+	ops = xcalloc(strlen(s) + 1, sizeof *ops);
+	while (*ptr != '\0') {
+		if (*ptr != '%' || ptr[1] == '%') {
+			start = ptr;
+			if (*ptr == '%')
+				start = ++ptr;
+			for (ptr++; *ptr != '\0' && *ptr != '%'; ptr++)
+				/* nothing */;
+			ops[n].type = TTYOP_LITERAL;
+			ops[n].value = start - s;
+			ops[n].length = ptr - start;
+			literal += ptr - start;
+			n++;
+			continue;
+		}
+		ptr++;
+
+		switch (*ptr++) {
+		case 'p':
+			if (*ptr < '1' || *ptr > '9')
+				goto fail;
+			ops[n].type = TTYOP_PARAM;
+			ops[n].value = *ptr++ - '1';
+			params++;
+			break;
+		case '{':
+			if (*ptr < '0' || *ptr > '9')
+				goto fail;
+			value = 0;
+			while (*ptr >= '0' && *ptr <= '9') {
+				if (value > 100000)
+					goto fail;
+				value = (value * 10) + (*ptr++ - '0');
+			}
+			if (*ptr++ != '}')
+				goto fail;
+			ops[n].type = TTYOP_CONSTANT;
+			ops[n].value = value;
+			break;
+		case '\'':
+			if (*ptr == '\0' || ptr[1] != '\'')
+				goto fail;
+			ops[n].type = TTYOP_CONSTANT;
+			ops[n].value = (u_char)*ptr;
+			ptr += 2;
+			break;
+		case 'i':
+			ops[n].type = TTYOP_INCREMENT;
+			break;
+		case 'd':
+			ops[n].type = TTYOP_PRINT;
+			prints++;
+			break;
+		case '!':
+			ops[n].type = TTYOP_NOT;
+			break;
+		case '~':
+			ops[n].type = TTYOP_COMPLEMENT;
+			break;
+		case '+':
+			ops[n].type = TTYOP_ADD;
+			break;
+		case '-':
+			ops[n].type = TTYOP_SUBTRACT;
+			break;
+		case '*':
+			ops[n].type = TTYOP_MULTIPLY;
+			break;
+		case '/':
+			ops[n].type = TTYOP_DIVIDE;
+			break;
+		case 'm':
+			ops[n].type = TTYOP_MODULO;
+			break;
+		case '&':
+			ops[n].type = TTYOP_AND;
+			break;
+		case '|':
+			ops[n].type = TTYOP_OR;
+			break;
+		case '^':
+			ops[n].type = TTYOP_XOR;
+			break;
+		case '=':
+			ops[n].type = TTYOP_EQUAL;
+			break;
+		case '>':
+			ops[n].type = TTYOP_GREATER;
+			break;
+		case '<':
+			ops[n].type = TTYOP_LESS;
+			break;
+		case 'A':
+			ops[n].type = TTYOP_LOGICAL_AND;
+			break;
+		case 'O':
+			ops[n].type = TTYOP_LOGICAL_OR;
+			break;
+		case '?':
+			if (nest == TTY_TERM_MAX_NEST)
+				goto fail;
+			level = &levels[nest++];
+			level->jump_false = -1;
+			level->njumps = 0;
+			continue;
+		case 't':
+			if (nest == 0)
+				goto fail;
+			level = &levels[nest - 1];
+			level->jump_false = n;
+			ops[n].type = TTYOP_JUMP_FALSE;
+			break;
+		case 'e':
+			if (nest == 0)
+				goto fail;
+			level = &levels[nest - 1];
+			if (level->njumps == TTY_TERM_MAX_JUMPS)
+				goto fail;
+			level->jumps[level->njumps++] = n;
+			ops[n].type = TTYOP_JUMP;
+			n++;
+			if (level->jump_false != -1) {
+				ops[level->jump_false].value = n;
+				level->jump_false = -1;
+			}
+			continue;
+		case ';':
+			if (nest == 0)
+				goto fail;
+			level = &levels[--nest];
+			if (level->jump_false != -1)
+				ops[level->jump_false].value = n;
+			for (i = 0; i < level->njumps; i++)
+				ops[level->jumps[i]].value = n;
+			continue;
+		default:
+			goto fail;
+		}
+		n++;
+	}
+	if (nest != 0)
+		goto fail;
+
+	/*
+	 * Strings with no %p are termcap-style and have their parameters
+	 * pushed implicitly by tparm, so leave them alone.
+	 */
+	if (prints != 0 && params == 0)
+		goto fail;
+	if (literal + prints * 11 >= TTY_TERM_MAX_OUTPUT)
+		goto fail;
+
+	ops[n].type = TTYOP_END;
+	return (ops);
+
+fail:
+	free(ops);
+	return (NULL);
+}
+
+/* Expand a compiled string into a static buffer. */
+static const char *
+tty_term_run(const struct tty_term_op *ops, const char *s, int a, int b, int c)
+{
+	static char			 buf[TTY_TERM_MAX_OUTPUT];
+	const struct tty_term_op	*op;
+	int				 params[9] = { a, b, c };
+	int				 stack[TTY_TERM_MAX_STACK], x, y;
+	u_int				 depth = 0;
+	size_t				 len = 0;
+	char				 tmp[16];
+	u_int				 tmplen;
+
+#define TTY_TERM_PUSH(v) do {			\
+	if (depth < TTY_TERM_MAX_STACK)		\
+		stack[depth++] = (v);		\
+} while (0)
+#define TTY_TERM_POP() (depth == 0 ? 0 : stack[--depth])
+
+	op = ops;
+	for (;;) {
+		switch (op->type) {
+		case TTYOP_END:
+			buf[len] = '\0';
+			return (buf);
+		case TTYOP_LITERAL:
+			memcpy(buf + len, s + op->value, op->length);
+			len += op->length;
+			break;
+		case TTYOP_PARAM:
+			TTY_TERM_PUSH(params[op->value]);
+			break;
+		case TTYOP_CONSTANT:
+			TTY_TERM_PUSH(op->value);
+			break;
+		case TTYOP_INCREMENT:
+			params[0]++;
+			params[1]++;
+			break;
+		case TTYOP_PRINT:
+			x = TTY_TERM_POP();
+			if (x >= 0 && x < 10)
+				buf[len++] = '0' + x;
+			else {
+				y = x;
+				tmplen = 0;
+				do {
+					tmp[tmplen++] = '0' + abs(y % 10);
+					y /= 10;
+				} while (y != 0);
+				if (x < 0)
+					buf[len++] = '-';
+				while (tmplen != 0)
+					buf[len++] = tmp[--tmplen];
+			}
+			break;
+		case TTYOP_NOT:
+			x = TTY_TERM_POP();
+			TTY_TERM_PUSH(!x);
+			break;
+		case TTYOP_COMPLEMENT:
+			x = TTY_TERM_POP();
+			TTY_TERM_PUSH(~x);
+			break;
+		case TTYOP_JUMP:
+			op = ops + op->value;
+			continue;
+		case TTYOP_JUMP_FALSE:
+			if (!TTY_TERM_POP()) {
+				op = ops + op->value;
+				continue;
+			}
+			break;
+		default:
+			y = TTY_TERM_POP();
+			x = TTY_TERM_POP();
+			switch (op->type) {
+			case TTYOP_ADD:
+				x += y;
+				break;
+			case TTYOP_SUBTRACT:
+				x -= y;
+				break;
+			case TTYOP_MULTIPLY:
+				x *= y;
+				break;
+			case TTYOP_DIVIDE:
+				x = (y == 0 ? 0 : x / y);
+				break;
+			case TTYOP_MODULO:
+				x = (y == 0 ? 0 : x % y);
+				break;
+			case TTYOP_AND:
+				x &= y;
+				break;
+			case TTYOP_OR:
+				x |= y;
+				break;
+			case TTYOP_XOR:
+				x ^= y;
+				break;
+			case TTYOP_EQUAL:
+				x = (x == y);
+				break;
+			case TTYOP_GREATER:
+				x = (x > y);
+				break;
+			case TTYOP_LESS:
+				x = (x < y);
+				break;
+			case TTYOP_LOGICAL_AND:
+				x = (x && y);
+				break;
+			case TTYOP_LOGICAL_OR:
+				x = (x || y);
+				break;
+			}
+			TTY_TERM_PUSH(x);
+			break;
+		}
+		op++;
+	}
+
+#undef TTY_TERM_PUSH
+#undef TTY_TERM_POP
+}
+
 static char *
 tty_term_override_next(const char *s, size_t *offset)
 {
@@ -546,6 +903,14 @@ tty_term_find(char *name, int fd, char **cause)
 	if (!tty_term_flag(term, TTYC_XENL))
 		term->flags |= TERM_EARLYWRAP;
 
+	/*
+	 * Terminals which end underline with SGR 24 rather than a full reset
+	 * implement the other ECMA-48 attribute off codes (22, 25, 27 and so
+	 * on) as well, so attributes can be turned off individually.
+	 */
+	if (strcmp(tty_term_string(term, TTYC_RMUL), "\033[24m") == 0)
+		term->flags |= TERM_SGROFF;
+
 	/* Generate ACS table. If none is present, use nearest ASCII. */
 	memset(term->acs, 0, sizeof term->acs);
 	if (tty_term_has(term, TTYC_ACSC))
@@ -582,6 +947,18 @@ tty_term_find(char *name, int fd, char **cause)
 		code->type = TTYCODE_STRING;
 	}
 
+	/* Compile any parameterized strings. */
+	for (i = 0; i < tty_term_ncodes(); i++) {
+		code = &term->codes[i];
+		if (code->type != TTYCODE_STRING)
+			continue;
+		if (strchr(code->value.string, '%') == NULL)
+			continue;
+		code->ops = tty_term_compile(code->value.string);
+		if (code->ops == NULL)
+			log_debug("%s: can't compile %s", name, tty_term_codes[i].name);
+	}
+
 	/* Log it. */
 	for (i = 0; i < tty_term_ncodes(); i++)
 		log_debug("%s%s", name, tty_term_describe(term, i));
@@ -606,6 +983,7 @@ tty_term_free(struct tty_term *term)
 	for (i = 0; i < tty_term_ncodes(); i++) {
 		if (term->codes[i].type == TTYCODE_STRING)
 			free(term->codes[i].value.string);
+		free(term->codes[i].ops);
 	}
 	free(term->codes);
 
@@ -632,19 +1010,31 @@ tty_term_string(struct tty_term *term, enum tty_code_code code)
 const char *
 tty_term_string1(struct tty_term *term, enum tty_code_code code, int a)
 {
-	return (tparm((char *) tty_term_string(term, code), a, 0, 0, 0, 0, 0, 0, 0, 0));
+	const char	*s = tty_term_string(term, code);
+
+	if (term->codes[code].ops != NULL)
+		return (tty_term_run(term->codes[code].ops, s, a, 0, 0));
+	return (tparm((char *) s, a, 0, 0, 0, 0, 0, 0, 0, 0));
 }
 
 const char *
 tty_term_string2(struct tty_term *term, enum tty_code_code code, int a, int b)
 {
-	return (tparm((char *) tty_term_string(term, code), a, b, 0, 0, 0, 0, 0, 0, 0));
+	const char	*s = tty_term_string(term, code);
+
+	if (term->codes[code].ops != NULL)
+		return (tty_term_run(term->codes[code].ops, s, a, b, 0));
+	return (tparm((char *) s, a, b, 0, 0, 0, 0, 0, 0, 0));
 }
 
 const char *
 tty_term_string3(struct tty_term *term, enum tty_code_code code, int a, int b, int c)
 {
-	return (tparm((char *) tty_term_string(term, code), a, b, c, 0, 0, 0, 0, 0, 0));
+	const char	*s = tty_term_string(term, code);
+
+	if (term->codes[code].ops != NULL)
+		return (tty_term_run(term->codes[code].ops, s, a, b, c));
+	return (tparm((char *) s, a, b, c, 0, 0, 0, 0, 0, 0));
 }
 
 const char *
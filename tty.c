@@ -45,6 +45,7 @@ static void	tty_cursor_pane_unless_wrap(struct tty *,
 		    const struct tty_ctx *, u_int, u_int);
 static void	tty_invalidate(struct tty *);
 static void	tty_colours(struct tty *, const struct grid_cell *);
+static int	tty_attributes_off(struct tty *, int);
 static void	tty_check_fg(struct tty *, struct window_pane *,
 		    struct grid_cell *);
 static void	tty_check_bg(struct tty *, struct window_pane *,
@@ -83,6 +84,9 @@ static void	tty_default_attributes(struct tty *, struct window_pane *,
 #define TTY_BLOCK_START(tty) (1 + ((tty)->sx * (tty)->sy) * 8)
 #define TTY_BLOCK_STOP(tty) (1 + ((tty)->sx * (tty)->sy) / 8)
 
+#define TTY_OUT_SIZE 16384
+#define TTY_OUT_SHRINK (TTY_OUT_SIZE * 16)
+
 void
 tty_create_log(void)
 {
@@ -197,7 +201,7 @@ static int
 tty_block_maybe(struct tty *tty)
 {
 	struct client	*c = tty->client;
-	size_t		 size = EVBUFFER_LENGTH(tty->out);
+	size_t		 size = tty_output_pending(tty);
 	struct timeval	 tv = { .tv_usec = TTY_BLOCK_INTERVAL };
 
 	if (size < TTY_BLOCK_START(tty))
@@ -209,7 +213,7 @@ tty_block_maybe(struct tty *tty)
 
 	log_debug("%s: can't keep up, %zu discarded", c->name, size);
 
-	evbuffer_drain(tty->out, size);
+	tty->out_off = tty->out_len = 0;
 	c->discarded += size;
 
 	tty->discarded = 0;
@@ -220,15 +224,55 @@ tty_block_maybe(struct tty *tty)
 static void
 tty_write_callback(__unused int fd, __unused short events, void *data)
 {
-	struct tty	*tty = data;
+	tty_flush(data);
+}
+
+/* Get the number of bytes waiting to be written. */
+size_t
+tty_output_pending(struct tty *tty)
+{
+	return (tty->out_len - tty->out_off);
+}
+
+/*
+ * Write as much of the output buffer as possible. Called at the end of each
+ * server loop so everything generated in that iteration goes out in a single
+ * write; if the terminal can't take it all, the rest waits for the fd to
+ * become writable.
+ */
+void
+tty_flush(struct tty *tty)
+{
 	struct client	*c = tty->client;
-	size_t		 size = EVBUFFER_LENGTH(tty->out);
-	int		 nwrite;
+	size_t		 size = tty_output_pending(tty);
+	ssize_t		 nwrite;
+	struct timeval	 tv;
 
-	nwrite = evbuffer_write(tty->out, tty->fd);
-	if (nwrite == -1)
+	if (size == 0 || (~tty->flags & TTY_STARTED))
 		return;
-	log_debug("%s: wrote %d bytes (of %zu)", c->name, nwrite, size);
+
+	nwrite = write(tty->fd, tty->out + tty->out_off, size);
+	if (nwrite == -1) {
+		if (errno != EAGAIN && errno != EINTR)
+			return;
+		nwrite = 0;
+	}
+	c->writes++;
+	log_debug("%s: wrote %zd bytes (of %zu)", c->name, nwrite, size);
+
+	tty->out_off += nwrite;
+	if (tty->out_off == tty->out_len) {
+		tty->out_off = tty->out_len = 0;
+
+		gettimeofday(&tv, NULL);
+		timersub(&tv, &tty->out_time, &tv);
+		c->write_latency = tv.tv_sec * 1000000 + tv.tv_usec;
+
+		if (tty->out_size > TTY_OUT_SHRINK) {
+			tty->out = xrealloc(tty->out, TTY_OUT_SIZE);
+			tty->out_size = TTY_OUT_SIZE;
+		}
+	}
 
 	if (c->redraw > 0) {
 		if ((size_t)nwrite >= c->redraw)
@@ -240,7 +284,7 @@ tty_write_callback(__unused int fd, __unused short events, void *data)
 	} else if (tty_block_maybe(tty))
 		return;
 
-	if (EVBUFFER_LENGTH(tty->out) != 0)
+	if (tty_output_pending(tty) != 0)
 		event_add(&tty->event_out, NULL);
 }
 
@@ -263,9 +307,9 @@ tty_open(struct tty *tty, char **cause)
 		fatal("out of memory");
 
 	event_set(&tty->event_out, tty->fd, EV_WRITE, tty_write_callback, tty);
-	tty->out = evbuffer_new();
-	if (tty->out == NULL)
-		fatal("out of memory");
+	tty->out = xmalloc(TTY_OUT_SIZE);
+	tty->out_size = TTY_OUT_SIZE;
+	tty->out_off = tty->out_len = 0;
 
 	evtimer_set(&tty->timer, tty_timer_callback, tty);
 
@@ -400,7 +444,8 @@ tty_close(struct tty *tty)
 	if (tty->flags & TTY_OPENED) {
 		evbuffer_free(tty->in);
 		event_del(&tty->event_in);
-		evbuffer_free(tty->out);
+		free(tty->out);
+		tty->out = NULL;
 		event_del(&tty->event_out);
 
 		tty_term_free(tty->term);
@@ -499,23 +544,108 @@ tty_putcode_ptr2(struct tty *tty, enum tty_code_code code, const void *a,
 }
 
 static void
-tty_add(struct tty *tty, const char *buf, size_t len)
+tty_add1(struct tty *tty, const char *buf, size_t len)
 {
 	struct client	*c = tty->client;
+	size_t		 size;
 
 	if (tty->flags & TTY_BLOCK) {
 		tty->discarded += len;
 		return;
 	}
 
-	evbuffer_add(tty->out, buf, len);
+	if (tty->out_len == 0)
+		gettimeofday(&tty->out_time, NULL);
+	if (tty->out_len + len > tty->out_size) {
+		if (tty->out_off != 0) {
+			size = tty->out_len - tty->out_off;
+			memmove(tty->out, tty->out + tty->out_off, size);
+			tty->out_off = 0;
+			tty->out_len = size;
+		}
+		size = tty->out_size;
+		while (tty->out_len + len > size)
+			size *= 2;
+		if (size != tty->out_size) {
+			tty->out = xrealloc(tty->out, size);
+			tty->out_size = size;
+		}
+	}
+	memcpy(tty->out + tty->out_len, buf, len);
+	tty->out_len += len;
+
 	log_debug("%s: %.*s", c->name, (int)len, buf);
 	c->written += len;
 
 	if (tty_log_fd != -1)
 		write(tty_log_fd, buf, len);
-	if (tty->flags & TTY_STARTED)
-		event_add(&tty->event_out, NULL);
+}
+
+/* Write out any pending SGR parameters as one sequence. */
+static void
+tty_sgr_flush(struct tty *tty)
+{
+	char	buf[sizeof tty->sgr + 3];
+	size_t	len;
+
+	if (tty->sgr_count == 0)
+		return;
+	if (tty->sgr_count == 1 && tty->sgr_len == 1 && tty->sgr[0] == '0')
+		len = xsnprintf(buf, sizeof buf, "\033[m");
+	else {
+		len = xsnprintf(buf, sizeof buf, "\033[%.*s", (int)tty->sgr_len,
+		    tty->sgr);
+		buf[len++] = 'm';
+	}
+	tty->sgr_len = 0;
+	tty->sgr_count = 0;
+	tty_add1(tty, buf, len);
+}
+
+/*
+ * If this is a plain SGR sequence, add its parameters to the pending sequence
+ * instead of writing it. Returns 0 if it is something else.
+ */
+static int
+tty_sgr_add(struct tty *tty, const char *buf, size_t len)
+{
+	size_t	i;
+
+	if (len < 3 || buf[0] != '\033' || buf[1] != '[' || buf[len - 1] != 'm')
+		return (0);
+	for (i = 2; i < len - 1; i++) {
+		if ((buf[i] < '0' || buf[i] > '9') && buf[i] != ';' &&
+		    buf[i] != ':')
+			return (0);
+	}
+	buf += 2;
+	len -= 3;
+	if (len == 0) {
+		buf = "0";
+		len = 1;
+	}
+
+	if (tty->sgr_count == 16 || tty->sgr_len + len + 1 > sizeof tty->sgr)
+		tty_sgr_flush(tty);
+	if (len + 1 > sizeof tty->sgr)
+		return (0);
+	if (tty->sgr_count != 0)
+		tty->sgr[tty->sgr_len++] = ';';
+	memcpy(tty->sgr + tty->sgr_len, buf, len);
+	tty->sgr_len += len;
+	tty->sgr_count++;
+	return (1);
+}
+
+static void
+tty_add(struct tty *tty, const char *buf, size_t len)
+{
+	if (tty->flags & TTY_SGR) {
+		if (tty_sgr_add(tty, buf, len))
+			return;
+		tty_sgr_flush(tty);
+	}
+	tty_add1(tty, buf, len);
 }
 
 void
@@ -1822,11 +1952,22 @@ tty_cmd_cells(struct tty *tty, const struct tty_ctx *ctx)
 		return;
 	}
 
+	/*
+	 * If there is UTF-8 that the terminal can't show or might split when
+	 * it would wrap early, draw the line instead.
+	 */
+	if (ctx->ptrlen != ctx->num &&
+	    ((~tty->flags & TTY_UTF8) ||
+	    (tty->term->flags & TERM_EARLYWRAP))) {
+		tty_draw_pane(tty, ctx, ctx->ocy);
+		return;
+	}
+
 	tty_margin_off(tty);
 	tty_cursor_pane_unless_wrap(tty, ctx, ctx->ocx, ctx->ocy);
 
 	tty_attributes(tty, ctx->cell, ctx->wp);
-	tty_putn(tty, ctx->ptr, ctx->num, ctx->num);
+	tty_putn(tty, ctx->ptr, ctx->ptrlen, ctx->num);
 }
 
 void
@@ -2213,11 +2354,21 @@ tty_attributes(struct tty *tty, const struct grid_cell *gc,
 	tty_check_bg(tty, wp, &gc2);
 	tty_check_us(tty, wp, &gc2);
 
+	/*
+	 * Collect the SGR sequences written from here on and send them as
+	 * one.
+	 */
+	tty->flags |= TTY_SGR;
+
 	/*
 	 * If any bits are being cleared or the underline colour is now default,
-	 * reset everything.
+	 * reset everything - unless the terminal can turn off the attributes
+	 * individually.
 	 */
-	if ((tc->attr & ~gc2.attr) || (tc->us != gc2.us && gc2.us == 0))
+	if (tc->us != gc2.us && gc2.us == 0)
+		tty_reset(tty);
+	else if ((tc->attr & ~gc2.attr) &&
+	    !tty_attributes_off(tty, tc->attr & ~gc2.attr))
 		tty_reset(tty);
 
 	/*
@@ -2266,6 +2417,87 @@ tty_attributes(struct tty *tty, const struct grid_cell *gc,
 		tty_putcode(tty, TTYC_SMOL);
 	if ((changed & GRID_ATTR_CHARSET) && tty_acs_needed(tty))
 		tty_putcode(tty, TTYC_SMACS);
+
+	tty->flags &= ~TTY_SGR;
+	tty_sgr_flush(tty);
+}
+
+/*
+ * Turn off attributes using the ECMA-48 off codes. Bold and dim share an off
+ * code, as may reverse and italics shown as standout, so both are cleared
+ * from the current state and the caller will set again whichever is still
+ * wanted. Returns 0 if the terminal can't do this.
+ */
+static int
+tty_attributes_off(struct tty *tty, int cleared)
+{
+	struct grid_cell	*tc = &tty->cell;
+	int			 italics_smso = 0, rmso_rev = 0;
+	const char		*s;
+
+	if (~tty->term->flags & TERM_SGROFF)
+		return (0);
+
+	/* Italics may have been shown as standout, see tty_set_italics. */
+	if (tc->attr & GRID_ATTR_ITALICS) {
+		s = options_get_string(global_options, "default-terminal");
+		if (!tty_term_has(tty->term, TTYC_SITM) ||
+		    strcmp(s, "screen") == 0 ||
+		    strncmp(s, "screen-", 7) == 0) {
+			if (!tty_term_has(tty->term, TTYC_RMSO))
+				return (0);
+			italics_smso = 1;
+			s = tty_term_string(tty->term, TTYC_RMSO);
+			rmso_rev = (strcmp(s, "\033[27m") == 0);
+		}
+	}
+	if ((cleared & GRID_ATTR_REVERSE) && !tty_term_has(tty->term, TTYC_REV))
+		return (0);
+
+	if (cleared & (GRID_ATTR_BRIGHT|GRID_ATTR_DIM)) {
+		tty_puts(tty, "\033[22m");
+		tc->attr &= ~(GRID_ATTR_BRIGHT|GRID_ATTR_DIM);
+	}
+	if (cleared & GRID_ATTR_ITALICS) {
+		if (italics_smso)
+			tty_putcode(tty, TTYC_RMSO);
+		else
+			tty_puts(tty, "\033[23m");
+		tc->attr &= ~GRID_ATTR_ITALICS;
+	}
+	if (italics_smso && (cleared & (GRID_ATTR_ITALICS|GRID_ATTR_REVERSE)))
+		tc->attr &= ~(GRID_ATTR_ITALICS|GRID_ATTR_REVERSE);
+	if (cleared & GRID_ATTR_ALL_UNDERSCORE) {
+		tty_putcode(tty, TTYC_RMUL);
+		tc->attr &= ~GRID_ATTR_ALL_UNDERSCORE;
+	}
+	if (cleared & GRID_ATTR_BLINK) {
+		tty_puts(tty, "\033[25m");
+		tc->attr &= ~GRID_ATTR_BLINK;
+	}
+	if (cleared & GRID_ATTR_REVERSE) {
+		if (!rmso_rev || (~cleared & GRID_ATTR_ITALICS))
+			tty_puts(tty, "\033[27m");
+		tc->attr &= ~GRID_ATTR_REVERSE;
+	}
+	if (cleared & GRID_ATTR_HIDDEN) {
+		tty_puts(tty, "\033[28m");
+		tc->attr &= ~GRID_ATTR_HIDDEN;
+	}
+	if (cleared & GRID_ATTR_STRIKETHROUGH) {
+		tty_puts(tty, "\033[29m");
+		tc->attr &= ~GRID_ATTR_STRIKETHROUGH;
+	}
+	if (cleared & GRID_ATTR_OVERLINE) {
+		tty_puts(tty, "\033[55m");
+		tc->attr &= ~GRID_ATTR_OVERLINE;
+	}
+	if (cleared & GRID_ATTR_CHARSET) {
+		if (tty_acs_needed(tty))
+			tty_putcode(tty, TTYC_RMACS);
+		tc->attr &= ~GRID_ATTR_CHARSET;
+	}
+	return (1);
 }
 
 static void
@@ -2332,7 +2564,6 @@ tty_colours(struct tty *tty, const struct grid_cell *gc)
 static void
 tty_check_fg(struct tty *tty, struct window_pane *wp, struct grid_cell *gc)
 {
-	u_char	r, g, b;
 	u_int	colours;
 	int	c;
 
@@ -2352,10 +2583,9 @@ tty_check_fg(struct tty *tty, struct window_pane *wp, struct grid_cell *gc)
 	/* Is this a 24-bit colour? */
 	if (gc->fg & COLOUR_FLAG_RGB) {
 		/* Not a 24-bit terminal? Translate to 256-colour palette. */
-		if (!tty_term_has(tty->term, TTYC_SETRGBF)) {
-			colour_split_rgb(gc->fg, &r, &g, &b);
-			gc->fg = colour_find_rgb(r, g, b);
-		} else
+		if (!tty_term_has(tty->term, TTYC_SETRGBF))
+			gc->fg = colour_RGBto256(gc->fg);
+		else
 			return;
 	}
 
@@ -2392,7 +2622,6 @@ tty_check_fg(struct tty *tty, struct window_pane *wp, struct grid_cell *gc)
 static void
 tty_check_bg(struct tty *tty, struct window_pane *wp, struct grid_cell *gc)
 {
-	u_char	r, g, b;
 	u_int	colours;
 	int	c;
 
@@ -2405,10 +2634,9 @@ tty_check_bg(struct tty *tty, struct window_pane *wp, struct grid_cell *gc)
 	/* Is this a 24-bit colour? */
 	if (gc->bg & COLOUR_FLAG_RGB) {
 		/* Not a 24-bit terminal? Translate to 256-colour palette. */
-		if (!tty_term_has(tty->term, TTYC_SETRGBB)) {
-			colour_split_rgb(gc->bg, &r, &g, &b);
-			gc->bg = colour_find_rgb(r, g, b);
-		} else
+		if (!tty_term_has(tty->term, TTYC_SETRGBB))
+			gc->bg = colour_RGBto256(gc->bg);
+		else
 			return;
 	}
 
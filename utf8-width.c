@@ -0,0 +1,1788 @@
+/* $OpenBSD$ */
+
+/*
+ * Generated by tools/utf8-width.py from Unicode 14.0.0. Do not edit.
+ */
+
+#include <sys/types.h>
+
+#include "tmux.h"
+
+const u_char utf8_width_index[4352] = {
+	  0,   1,   1,   2,   3,   4,   5,   6,   7,   8,   9,  10,
+	 11,  12,  13,  14,  15,  16,  17,  18,   1,   1,  19,  20,
+	 21,  22,  23,  24,  25,  26,   1,  27,  28,  29,   1,  30,
+	 31,  32,  33,  34,   1,   1,   1,  35,  36,  37,  38,  39,
+	 40,  41,  42,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  44,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  45,   1,  46,  47,
+	 48,  49,  50,  51,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  52,
+	 53,  53,  53,  53,  53,  53,  53,  53,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,  43,  43,  54,
+	  1,  55,  56,  57,  58,  59,  60,  61,  62,  63,   1,  64,
+	 65,  66,  67,  68,  69,  70,  71,  72,  73,  74,  75,  76,
+	 77,  78,  79,  80,  81,  82,  83,  53,  84,  85,  86,  87,
+	  1,   1,   1,  88,  89,  90,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  91,   1,   1,   1,   1,  92,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	  1,   1,  93,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	  1,   1,  94,  95,  53,  53,  96,  97,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  98,  43,  43,  43,  43,
+	 99, 100,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53, 101,
+	 43, 102, 103,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	104,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53, 105, 106, 107, 108, 109,
+	110, 111, 112, 113,   1,   1, 114,  53,  53,  53,  53, 115,
+	116, 117, 118,  53,  53,  53,  53, 119, 120, 121,  53,  53,
+	122, 123, 124,  53, 125, 126, 127, 128, 129, 130, 131, 132,
+	133, 134, 135, 136,  53,  53,  53,  53,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43, 137,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,  43,
+	 43,  43,  43, 137,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53, 138, 139,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	 53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,  53,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1, 140,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1, 140,
+};
+
+const u_char utf8_width_blocks[141][64] = {
+	{
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xd5,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x55, 0x55, 0x5f, 0x55,
+		0xff, 0x55, 0xd5, 0x5d, 0x55, 0x55, 0x55, 0x55,
+		0x75, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x15, 0x00, 0x50, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x57, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xd5, 0x57, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xd5, 0x57, 0x03, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10,
+		0x41, 0x10, 0xff, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xd5, 0x7f, 0x55, 0xfd, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x00, 0x00, 0x40, 0x54,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x15, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x55, 0x55, 0x55, 0x55, 0x54, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x05, 0x00, 0x14,
+		0x00, 0x14, 0x04, 0x50, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0x55, 0x55, 0x55, 0x75, 0x51, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0xc0, 0x57, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x05, 0x00, 0x00, 0xf4, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x15, 0x00, 0x00, 0x55, 0xd5, 0x53,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x05, 0x10, 0x00,
+		0x00, 0x01, 0x01, 0xf0, 0x55, 0x55, 0x55, 0xd5,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x01, 0xdf,
+		0x55, 0x55, 0xd5, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0xd5, 0xf5, 0xff, 0x00, 0x00,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	},
+	{
+		0x40, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x45, 0x54,
+		0x01, 0x00, 0x54, 0x51, 0x01, 0x00, 0x55, 0x55,
+		0x05, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x51, 0x57, 0x55, 0x7d, 0x7d, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x5d, 0x55, 0xdd, 0x5f, 0xf5, 0x54,
+		0x01, 0x7c, 0x7d, 0xd1, 0xff, 0x7f, 0xff, 0x75,
+		0x05, 0x5f, 0x55, 0x55, 0x55, 0x55, 0x55, 0xc5,
+	},
+	{
+		0x43, 0x57, 0xd5, 0x7f, 0x7d, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x5d, 0x55, 0x5d, 0xd7, 0xf5, 0x5c,
+		0xc1, 0x3f, 0x3c, 0xf0, 0xf3, 0xff, 0x57, 0xdd,
+		0xff, 0x5f, 0x55, 0x55, 0x50, 0xd1, 0xff, 0xff,
+		0x43, 0x57, 0x55, 0x75, 0x75, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x5d, 0x55, 0x5d, 0x57, 0xf5, 0x54,
+		0x01, 0x30, 0x74, 0xf1, 0xfd, 0xff, 0xff, 0xff,
+		0x05, 0x5f, 0x55, 0x55, 0xf5, 0xff, 0x07, 0x00,
+	},
+	{
+		0x53, 0x57, 0x55, 0x7d, 0x7d, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x5d, 0x55, 0x5d, 0x57, 0xf5, 0x14,
+		0x01, 0x7c, 0x7d, 0xf1, 0xff, 0x43, 0xff, 0x75,
+		0x05, 0x5f, 0x55, 0x55, 0x55, 0x55, 0xff, 0xff,
+		0x4f, 0x57, 0xd5, 0x5f, 0x5d, 0xf5, 0xd7, 0x5d,
+		0x7f, 0xfd, 0xd5, 0x5f, 0x55, 0x55, 0xf5, 0x5f,
+		0xd4, 0x5f, 0x5d, 0xf1, 0xfd, 0x7f, 0xff, 0xff,
+		0xff, 0x5f, 0x55, 0x55, 0x55, 0x55, 0xd5, 0xff,
+	},
+	{
+		0x54, 0x54, 0x55, 0x5d, 0x5d, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x5d, 0x55, 0x55, 0x55, 0xf5, 0x04,
+		0x54, 0x0d, 0x0c, 0xf0, 0xff, 0xc3, 0xd5, 0xf7,
+		0x05, 0x5f, 0x55, 0x55, 0xff, 0x7f, 0x55, 0x55,
+		0x51, 0x55, 0x55, 0x5d, 0x5d, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x5d, 0x55, 0x55, 0x57, 0xf5, 0x14,
+		0x55, 0x4d, 0x5d, 0xf0, 0xff, 0xd7, 0xff, 0xd7,
+		0x05, 0x5f, 0x55, 0x55, 0xd7, 0xff, 0xff, 0xff,
+	},
+	{
+		0x50, 0x55, 0x55, 0x5d, 0x5d, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x15, 0x54,
+		0x01, 0x5c, 0x5d, 0x51, 0xff, 0x55, 0x55, 0x55,
+		0x05, 0x5f, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x53, 0x57, 0x55, 0x55, 0x55, 0xd5, 0x5f, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x75, 0x55, 0x55, 0xf7,
+		0x55, 0xd5, 0xcf, 0x7f, 0x05, 0xcc, 0x55, 0x55,
+		0xff, 0x5f, 0x55, 0x55, 0x5f, 0xfd, 0xff, 0xff,
+	},
+	{
+		0x57, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x51, 0x00, 0xc0, 0x7f,
+		0x55, 0x15, 0x00, 0x40, 0x55, 0x55, 0x55, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xd7, 0x5d, 0xd5, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x77, 0x55, 0x55, 0x51, 0x00, 0x00, 0xf4,
+		0x55, 0xdd, 0x00, 0xf0, 0x55, 0x55, 0xf5, 0x55,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x50, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x11, 0x51, 0x55,
+		0x55, 0x55, 0x57, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0xfd, 0x03, 0x00, 0x00, 0x40,
+		0x00, 0x04, 0x55, 0x01, 0x00, 0x00, 0x03, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5c,
+		0x55, 0x45, 0x55, 0x5d, 0x55, 0x55, 0xd5, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x01, 0x04, 0x00, 0x41, 0x41,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x50, 0x05,
+		0x54, 0x55, 0x55, 0x55, 0x01, 0x54, 0x55, 0x55,
+		0x45, 0x41, 0x55, 0x51, 0x55, 0x55, 0x55, 0x51,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x75, 0xff, 0xf7, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x5d, 0xf5, 0x55, 0xd5, 0x5d, 0xf5,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x5d, 0xf5, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x5d, 0xf5, 0x55, 0xd5,
+		0x5d, 0xf5, 0x55, 0x55, 0x55, 0xd5, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x5d, 0xf5, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xd5, 0x03,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xfd,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xf5, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xf5, 0x55, 0xf5,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xfd,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xfd, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x05, 0xf4, 0xff, 0x7f,
+		0x55, 0x55, 0x55, 0x55, 0x05, 0xd5, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x05, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x5d, 0x0d, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x10, 0x00, 0x50,
+		0x55, 0x45, 0x01, 0x00, 0x00, 0x55, 0x55, 0xf1,
+		0x55, 0x55, 0xf5, 0xff, 0x55, 0x55, 0xf5, 0xff,
+	},
+	{
+		0x55, 0x55, 0x15, 0x00, 0x55, 0x55, 0xf5, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xfd, 0xff,
+		0x55, 0x41, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xd1, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xf5, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xd5,
+		0x40, 0x15, 0x54, 0xff, 0x45, 0x55, 0x01, 0xff,
+		0xfd, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0xf5, 0x55, 0xfd, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xf5, 0xff, 0x55, 0x55, 0xd5, 0x5f,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x15, 0x14, 0x5f,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x45, 0x00, 0xc0,
+		0x44, 0x01, 0x00, 0x54, 0x15, 0x00, 0x00, 0x3c,
+		0x55, 0x55, 0xf5, 0xff, 0x55, 0x55, 0xf5, 0xff,
+		0x55, 0x55, 0x55, 0xf5, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0xc0, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x00, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x04, 0x40, 0x54,
+		0x45, 0x55, 0x55, 0xfd, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x15, 0x00, 0x00, 0x55, 0x55, 0xd5,
+		0x50, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x05, 0x50, 0x10, 0x50, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x45, 0x50, 0x11, 0x50, 0xff, 0xff, 0x55,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x00, 0x00, 0x05, 0x7f, 0x55,
+		0x55, 0x55, 0xf5, 0x57, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xfd, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xd5, 0x57,
+		0x55, 0x55, 0xff, 0xff, 0x40, 0x00, 0x00, 0x00,
+		0x04, 0x00, 0x54, 0x51, 0x55, 0x54, 0xd0, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xf5, 0x55, 0xf5,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0xf5, 0x55, 0xf5, 0x55, 0x55, 0x77, 0x77,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xf5,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x5d, 0x55, 0x55,
+		0x55, 0x5d, 0x55, 0x55, 0x55, 0x5f, 0x55, 0x57,
+		0x55, 0x55, 0x55, 0x55, 0x5f, 0x5d, 0x55, 0xd5,
+	},
+	{
+		0x55, 0x55, 0x15, 0x00, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x05, 0x40, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x00, 0x0c, 0x00, 0x00, 0xf5, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0xd5, 0x55, 0x55, 0x55, 0xfd,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0xfd, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0xfc, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0x55,
+		0x55, 0x55, 0x69, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xa9, 0x56, 0x96, 0x55, 0x55, 0x55,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0xd5, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0xd5, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x69,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x5a, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95,
+		0x55, 0x55, 0x55, 0x55, 0x95, 0x55, 0x55, 0x55,
+		0x59, 0x55, 0xa5, 0x55, 0x55, 0x55, 0x55, 0x69,
+		0x55, 0x5a, 0x55, 0x65, 0x55, 0x56, 0x55, 0x55,
+		0x55, 0x55, 0x65, 0x55, 0xa5, 0x59, 0x65, 0x59,
+	},
+	{
+		0x55, 0x59, 0xa5, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x56, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x66, 0x95, 0x9a, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xa9, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x56, 0x55, 0x55, 0x95,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0x56,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x56, 0x59, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x5f, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x75, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x15, 0x50, 0xff, 0x57, 0x55,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x75, 0xff, 0xf7, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xff, 0x7f, 0xfd, 0xff, 0xff, 0x3f,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xd5, 0xff, 0xff,
+		0x55, 0xd5, 0x55, 0xd5, 0x55, 0xd5, 0x55, 0xd5,
+		0x55, 0xd5, 0x55, 0xd5, 0x55, 0xd5, 0x55, 0xd5,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xf5,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xba, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xff, 0xff, 0xff,
+	},
+	{
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xfa, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xaa, 0xaa, 0xaa, 0xff,
+	},
+	{
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0x0a, 0xa0, 0xaa, 0xaa, 0xaa, 0x6a,
+		0xab, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xea, 0x83, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+	},
+	{
+		0xff, 0xab, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xab, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xea, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xff, 0xff, 0xff, 0xaa, 0xaa, 0xaa, 0xaa,
+	},
+	{
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xea,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0x55, 0x55, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+	},
+	{
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+	},
+	{
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xfe, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xea, 0xff, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x15, 0x40, 0x00, 0x00, 0x50,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x05,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x50, 0x55, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xd5, 0xff, 0x75, 0x57, 0xf5, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0x5f, 0x55, 0x55, 0x55,
+	},
+	{
+		0x45, 0x45, 0x15, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x41, 0x55, 0xfc, 0x55, 0x55, 0xf5, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0xf0, 0xff, 0x5f, 0x55, 0x55, 0xf5, 0xff,
+		0x00, 0x00, 0x00, 0x00, 0x50, 0x55, 0x55, 0x15,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x05, 0x00, 0x50, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x15, 0x00, 0x00, 0x50, 0xff, 0xff, 0x7f,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xfe,
+		0x40, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x15, 0x05, 0x50, 0x50,
+		0x55, 0x55, 0x55, 0x75, 0x55, 0x55, 0xf5, 0x5f,
+		0x55, 0x51, 0x55, 0x55, 0x55, 0x55, 0x55, 0xd5,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x01, 0x40, 0x41, 0xc1, 0xff, 0xff,
+		0x15, 0x55, 0x55, 0xf4, 0x55, 0x55, 0xf5, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x54,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x04, 0x14, 0x54, 0x05,
+		0xd1, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f, 0x55,
+		0x55, 0x55, 0x55, 0x50, 0x55, 0xc5, 0xff, 0xff,
+	},
+	{
+		0x57, 0xd5, 0x57, 0xd5, 0x57, 0xd5, 0xff, 0xff,
+		0x55, 0xd5, 0x55, 0xd5, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x51, 0x54, 0xf1, 0x55, 0x55, 0xf5, 0xff,
+	},
+	{
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0xc0, 0x3f, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff,
+	},
+	{
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0xd5, 0xff, 0xff, 0x7f, 0x55, 0xff, 0x47,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xd5, 0x55, 0xdd,
+		0x75, 0x5d, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0xd5, 0xff, 0xff, 0xff, 0x7f, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x5f, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xff, 0x7f, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0x00, 0x00, 0x00, 0x00, 0xaa, 0xaa, 0xfa, 0xff,
+		0x00, 0x00, 0x00, 0x00, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xea, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xea, 0xaa, 0xff, 0x55, 0x5d, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x3d,
+	},
+	{
+		0xab, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0x56, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xd5,
+		0x5f, 0x55, 0x5f, 0x55, 0x5f, 0x55, 0x5f, 0xfd,
+		0xaa, 0xea, 0x55, 0xd5, 0xff, 0xff, 0x03, 0xf5,
+	},
+	{
+		0x55, 0x55, 0x55, 0x57, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0xd5, 0x55, 0x55, 0x55, 0x55, 0xd5, 0x75,
+		0x55, 0x55, 0x55, 0xf5, 0x55, 0x55, 0x55, 0xf5,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xd5, 0xff,
+	},
+	{
+		0xd5, 0x7f, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x7f, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0xd5, 0x55, 0x55, 0x55, 0xfd,
+		0xfd, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xf1,
+	},
+	{
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xfd,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0xfd, 0xff, 0xff, 0xff,
+		0x54, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0xff, 0xff, 0x57, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xd5, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x05, 0xc0, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x75,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0xff, 0x55, 0x55, 0x55, 0xf5, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xf5,
+		0x55, 0x55, 0xf5, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xff, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xff, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0xff, 0xff, 0x7f, 0x55, 0x55, 0xd5, 0x55,
+		0x55, 0x55, 0xd5, 0x55, 0xd5, 0x75, 0x55, 0x55,
+		0x75, 0x55, 0x55, 0x55, 0x75, 0x55, 0x75, 0xfd,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xd5, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xf5, 0xff, 0xff,
+		0x55, 0x55, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x75, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x5d, 0x55, 0xd5, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0xf5, 0x5d, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x75, 0xfd, 0x7d,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x75, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xd5,
+		0xff, 0x7f, 0x55, 0x55, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0xd5, 0xf5, 0x7f, 0x55,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x7f,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xf5, 0x7f,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xff, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x5f, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0x01, 0xc3, 0xff, 0x00, 0x55, 0x57, 0x57, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xf5, 0xc0, 0x3f,
+		0x55, 0x55, 0xfd, 0xff, 0x55, 0x55, 0xfd, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0xc1, 0x7f, 0x55, 0x55, 0xd5, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xf5, 0x57, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xf5, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0xd5, 0xff, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0xf5, 0xff, 0x57, 0xfd,
+		0xff, 0xff, 0x57, 0x55, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xfd, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0xd5, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0xd5, 0xff, 0x5f, 0x55,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x00, 0xff, 0xff, 0x55, 0x55, 0xf5, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xd5,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x35, 0xf4, 0xf5, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xff, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x05, 0x00, 0x00, 0x54, 0x55, 0xf5, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x05, 0x50, 0xf5, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xd5, 0xff, 0xff,
+	},
+	{
+		0x51, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x00, 0x00,
+		0x00, 0x40, 0x55, 0xf5, 0x5f, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x14, 0xf4, 0xff, 0x3f,
+		0x50, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x15, 0x40, 0x41, 0x55,
+		0xc5, 0xff, 0xff, 0xf7, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xfd, 0xff, 0x55, 0x55, 0xf5, 0xff,
+	},
+	{
+		0x40, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x15, 0x00, 0x01, 0x00, 0x5c, 0x55, 0x55,
+		0x55, 0x55, 0xff, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x15, 0xd5, 0xff, 0xff,
+		0x50, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x05, 0x00, 0x40,
+		0x55, 0x55, 0x01, 0x14, 0x55, 0x55, 0x55, 0x55,
+		0x57, 0x55, 0x55, 0x55, 0x55, 0xfd, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x75, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x15, 0x50, 0x04, 0x55, 0xc5,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0xd5, 0x5d, 0x75, 0x55, 0x55, 0x55, 0x75,
+		0x55, 0x55, 0xf5, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x15,
+		0x15, 0x00, 0xc0, 0xff, 0x55, 0x55, 0xf5, 0xff,
+	},
+	{
+		0x50, 0x57, 0x55, 0x7d, 0x7d, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x5d, 0x55, 0x5d, 0x57, 0x35, 0x54,
+		0x54, 0x7d, 0x7d, 0xf5, 0xfd, 0x7f, 0xff, 0x57,
+		0x55, 0x0f, 0x00, 0xfc, 0x00, 0xfc, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x00, 0x00,
+		0x05, 0x44, 0x55, 0x55, 0x55, 0x55, 0x55, 0x47,
+		0xf5, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x15, 0x00, 0x44, 0x15,
+		0x04, 0x55, 0xff, 0xff, 0x55, 0x55, 0xf5, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x05, 0xf0, 0x55, 0x10,
+		0x54, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xf0,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x15, 0x00, 0x40, 0x11,
+		0x54, 0xfd, 0xff, 0xff, 0x55, 0x55, 0xf5, 0xff,
+		0x55, 0x55, 0x55, 0xfd, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x15, 0x51, 0x00, 0x10, 0xf5, 0xff,
+		0x55, 0x55, 0xf5, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xd5, 0x03,
+		0x05, 0x10, 0x00, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0xd5, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x15, 0x00, 0x00, 0x41, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0xd5, 0xff, 0xff, 0x7f,
+	},
+	{
+		0x55, 0xd5, 0xf7, 0x55, 0x55, 0xd7, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x75, 0x3d, 0x44,
+		0x15, 0xd5, 0xff, 0xff, 0x55, 0x55, 0xf5, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x5f, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x00, 0x0f, 0x55,
+		0x54, 0xfd, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x01, 0x00, 0x40, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x15, 0x00, 0x14, 0x40,
+		0x55, 0x15, 0xff, 0xff, 0x01, 0x40, 0x01, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x05, 0x00, 0x00, 0x40, 0x50, 0x55,
+		0xd5, 0xff, 0xff, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xfd, 0xff,
+	},
+	{
+		0x55, 0x55, 0x5d, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x00, 0xc0, 0x00, 0x10,
+		0x55, 0xf5, 0xff, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0xfd, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x0f, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x07, 0x00, 0x04, 0xc1, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0xd5, 0x75, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x01, 0xc0, 0xcf, 0x30,
+		0x00, 0x10, 0xff, 0xff, 0x55, 0x55, 0xf5, 0xff,
+		0x55, 0x75, 0x5d, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0xd5, 0x70, 0x11, 0xfd, 0xff,
+		0x55, 0x55, 0xf5, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x15, 0x54, 0xfd, 0xff,
+	},
+	{
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xfd, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0xf5, 0xff, 0xff, 0x7f,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xf5, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0xd5, 0x55, 0xfd, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0xd5, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0xd5, 0x00, 0x00, 0xfc, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0xd5, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xfd, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xd5,
+		0x55, 0x55, 0xf5, 0x5f, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xd5,
+		0x55, 0x55, 0xf5, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0xf5, 0x00, 0xf4, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x00, 0x40, 0x55, 0x55,
+		0x55, 0xf5, 0xff, 0xff, 0x55, 0x55, 0x75, 0x55,
+		0x75, 0x55, 0x55, 0x55, 0x55, 0x55, 0xff, 0x57,
+		0x55, 0x55, 0x55, 0x55, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xd5, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xd5, 0x3f, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xff, 0x3f, 0x40, 0x55, 0x55, 0x55,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xaa, 0xfc, 0xff, 0xff, 0xfa, 0xff, 0xff, 0xff,
+	},
+	{
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xff, 0xff,
+	},
+	{
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xfa, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0xaa, 0xaa, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xaa, 0xab, 0xaa, 0xeb,
+	},
+	{
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xea, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xea, 0xff, 0xff, 0xff,
+		0xff, 0xaa, 0xff, 0xff, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+	},
+	{
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xd5, 0xff, 0x55, 0x55, 0x55, 0xfd,
+		0x55, 0x55, 0xfd, 0xff, 0x55, 0x55, 0xf5, 0x41,
+		0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0xf0, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0xc0, 0xff, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xf5, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0xd5, 0x57, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x15, 0x50, 0x55, 0x15, 0x00, 0x00, 0x00,
+		0x40, 0x01, 0x00, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x05, 0x50, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xd5, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x05, 0xf4, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xd5, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xfd, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x5d, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x5d,
+		0xdf, 0xd7, 0x57, 0x5d, 0x55, 0x55, 0x75, 0x57,
+		0x55, 0x57, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0x55, 0x75, 0xd5, 0x57, 0x55, 0x5d, 0x55, 0x5d,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x75, 0xd5,
+		0x55, 0xdd, 0x5f, 0x55, 0x5d, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0xf5, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x5f, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x15, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x54, 0x55, 0x51, 0x55, 0x55,
+		0x55, 0x54, 0x55, 0xff, 0xff, 0xff, 0x3f, 0x00,
+		0x03, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xd5,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x00, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x3c, 0x00,
+		0x30, 0x0c, 0xc0, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0xfd, 0x00, 0x40, 0x55, 0xf5,
+		0x55, 0x55, 0xf5, 0x5f, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0xc5, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x00, 0x55, 0x55, 0xf5, 0x7f,
+	},
+	{
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x55, 0xd5, 0x55, 0xd7, 0x55, 0x55, 0x55, 0xd5,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x7d, 0x55, 0x55, 0x00, 0xc0, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x00, 0x40, 0xff, 0x55, 0x55, 0xf5, 0x5f,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0x57, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xfd, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x57, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xf5,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x57, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0xd7, 0x7d, 0x57, 0x55, 0xd5, 0x55, 0x77, 0xff,
+		0xdf, 0x7f, 0x77, 0x57, 0xd7, 0x7d, 0x77, 0x77,
+		0xd7, 0x7d, 0xd5, 0x55, 0xd5, 0x55, 0x57, 0xdd,
+		0x55, 0x55, 0x75, 0x55, 0x55, 0x55, 0x55, 0xff,
+		0x57, 0x57, 0x75, 0x55, 0x55, 0x55, 0x55, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xf5, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x56, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0xd5, 0x57, 0x55, 0x55, 0x55,
+		0x57, 0x55, 0x55, 0x95, 0x57, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xf5, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x65, 0xa9, 0xaa, 0x6a, 0x55,
+		0x55, 0x55, 0x55, 0xf5, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0x5f, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+	},
+	{
+		0xea, 0xff, 0xff, 0xff, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xff,
+		0xaa, 0xaa, 0xfe, 0xff, 0xfa, 0xff, 0xff, 0xff,
+		0xaa, 0xfa, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0x56, 0x55, 0x55, 0xa9, 0xaa, 0x9a, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xa6,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0x6a, 0x95, 0xaa, 0x55, 0x55, 0x55,
+		0xaa, 0xaa, 0xaa, 0xaa, 0x56, 0x56, 0xaa, 0xaa,
+	},
+	{
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x6a,
+		0xa6, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x96,
+	},
+	{
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x5a,
+		0x55, 0x55, 0x95, 0x6a, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x65, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x69, 0x55, 0x55,
+		0x55, 0x56, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0xaa,
+	},
+	{
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0x5a, 0x55, 0x56, 0x6a, 0xa9, 0xff, 0xab,
+		0x55, 0x55, 0x95, 0xfe, 0x55, 0xaa, 0xaa, 0xfe,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xfd, 0xff,
+		0xaa, 0xaa, 0xaa, 0xff, 0xfe, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xff, 0xff, 0x55, 0x55, 0xf5, 0xff,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xff, 0xff, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0xf5, 0xf5, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x6a, 0xaa,
+		0xaa, 0x9a, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0xff, 0xff, 0xff,
+		0x55, 0x55, 0x55, 0xf5, 0xaa, 0xfe, 0xaa, 0xfe,
+		0xaa, 0xea, 0xff, 0xff, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xfe, 0xaa, 0xaa, 0xea, 0xff,
+		0xaa, 0xfa, 0xff, 0xff, 0xaa, 0xaa, 0xfa, 0xff,
+		0xaa, 0xaa, 0xff, 0xff, 0xaa, 0xea, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0xd5, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0xd5, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0x55, 0x55, 0xf5, 0xff,
+	},
+	{
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+		0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xfa,
+	},
+	{
+		0xf3, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff,
+	},
+	{
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+		0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xf5,
+	},
+};
@@ -50,6 +50,19 @@ utf8_copy(struct utf8_data *to, const struct utf8_data *from)
 		to->data[i] = '\0';
 }
 
+/* Get the size of a UTF-8 character from its first byte. */
+u_int
+utf8_size(u_char ch)
+{
+	if (ch >= 0xf0)
+		return (4);
+	if (ch >= 0xe0)
+		return (3);
+	if (ch >= 0xc0)
+		return (2);
+	return (1);
+}
+
 /*
  * Open UTF-8 sequence.
  *
@@ -104,57 +117,131 @@ utf8_append(struct utf8_data *ud, u_char ch)
 	return (UTF8_DONE);
 }
 
-/* Get width of Unicode character. */
-static int
-utf8_width(wchar_t wc)
+/*
+ * Decode and measure a whole UTF-8 character from the start of a buffer,
+ * setting the number of bytes used. If the buffer does not start with a
+ * complete sequence, the character is opened with the first byte and
+ * UTF8_MORE is returned so the caller can append the rest a byte at a time.
+ */
+enum utf8_state
+utf8_decode(struct utf8_data *ud, const u_char *buf, size_t len, size_t *used)
 {
+	wchar_t	wc;
 	int	width;
+	u_int	i;
 
-#ifdef HAVE_UTF8PROC
-	width = utf8proc_wcwidth(wc);
-#else
-	width = wcwidth(wc);
-#endif
-	if (width < 0 || width > 0xff) {
-		log_debug("Unicode %04lx, wcwidth() %d", (long)wc, width);
+	*used = 1;
+	if (utf8_open(ud, buf[0]) != UTF8_MORE)
+		return (UTF8_ERROR);
+	if (len < ud->size)
+		return (UTF8_MORE);
+	for (i = 1; i < ud->size; i++) {
+		if ((buf[i] & 0xc0) != 0x80)
+			return (UTF8_MORE);
+	}
+	memcpy(ud->data, buf, ud->size);
+	ud->have = ud->size;
+	*used = ud->size;
+
+	if (utf8_combine(ud, &wc) != UTF8_DONE)
+		return (UTF8_ERROR);
+	if ((width = utf8_width(wc)) < 0)
+		return (UTF8_ERROR);
+	ud->width = width;
+	return (UTF8_DONE);
+}
+
+/*
+ * Get width of Unicode character from the table in utf8-width.c. This does
+ * not use wcwidth() because it is slow on some platforms and its results
+ * vary with the platform and locale.
+ */
+static int
+utf8_width(wchar_t wc)
+{
+	const u_char	*block;
+	u_int		 width;
+
+	if (wc < 0 || wc > 0x10ffff)
+		width = UTF8_WIDTH_UNKNOWN;
+	else {
+		block = utf8_width_blocks[utf8_width_index[wc >> 8]];
+		width = (block[(wc & 0xff) >> 2] >> ((wc & 3) * 2)) & 3;
+	}
+	if (width == UTF8_WIDTH_UNKNOWN) {
+		log_debug("Unicode %04lx, unknown width", (long)wc);
 
 #ifndef __OpenBSD__
 		/*
-		 * Many platforms (particularly and inevitably OS X) have no
-		 * width for relatively common characters (wcwidth() returns
-		 * -1); assume width 1 in this case. This will be wrong for
-		 * genuinely nonprintable characters, but they should be
-		 * rare. We may pass through stuff that ideally we would block,
-		 * but this is no worse than sending the same to the terminal
-		 * without tmux.
+		 * Assume width 1 for characters with no width (control
+		 * characters or those not yet assigned when the table was
+		 * built). This will be wrong for genuinely nonprintable
+		 * characters, but they should be rare. We may pass through
+		 * stuff that ideally we would block, but this is no worse than
+		 * sending the same to the terminal without tmux.
 		 */
-		if (width < 0)
-			return (1);
+		return (1);
 #endif
 		return (-1);
 	}
 	return (width);
 }
 
-/* Combine UTF-8 into Unicode. */
+/*
+ * Combine UTF-8 into Unicode. Overlong forms, surrogates and characters
+ * outside the Unicode range are rejected.
+ */
 enum utf8_state
 utf8_combine(const struct utf8_data *ud, wchar_t *wc)
 {
-#ifdef HAVE_UTF8PROC
-	switch (utf8proc_mbtowc(wc, ud->data, ud->size)) {
-#else
-	switch (mbtowc(wc, ud->data, ud->size)) {
-#endif
-	case -1:
-		log_debug("UTF-8 %.*s, mbtowc() %d", (int)ud->size, ud->data,
-		    errno);
-		mbtowc(NULL, NULL, MB_CUR_MAX);
-		return (UTF8_ERROR);
-	case 0:
-		return (UTF8_ERROR);
-	default:
+	const u_char	*cp = ud->data;
+	u_int		 i;
+	wchar_t		 value;
+
+	switch (ud->size) {
+	case 1:
+		if (cp[0] == 0 || cp[0] > 0x7f)
+			return (UTF8_ERROR);
+		*wc = cp[0];
 		return (UTF8_DONE);
+	case 2:
+		value = cp[0] & 0x1f;
+		break;
+	case 3:
+		value = cp[0] & 0x0f;
+		break;
+	case 4:
+		value = cp[0] & 0x07;
+		break;
+	default:
+		return (UTF8_ERROR);
+	}
+	for (i = 1; i < ud->size; i++) {
+		if ((cp[i] & 0xc0) != 0x80)
+			goto bad;
+		value = (value << 6) | (cp[i] & 0x3f);
+	}
+
+	switch (ud->size) {
+	case 2:
+		if (value < 0x80)
+			goto bad;
+		break;
+	case 3:
+		if (value < 0x800 || (value >= 0xd800 && value <= 0xdfff))
+			goto bad;
+		break;
+	case 4:
+		if (value < 0x10000 || value > 0x10ffff)
+			goto bad;
+		break;
 	}
+	*wc = value;
+	return (UTF8_DONE);
+
+bad:
+	log_debug("UTF-8 %.*s, invalid", (int)ud->size, ud->data);
+	return (UTF8_ERROR);
 }
 
 /* Split Unicode into UTF-8. */
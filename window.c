@@ -52,6 +52,9 @@
  * it reaches zero.
  */
 
+/* Maximum amount of pipe spill file read back at once. */
+#define WINDOW_PANE_PIPE_READ 65536
+
 /* Global window list. */
 struct windows windows;
 
@@ -77,6 +80,14 @@ struct window_pane_input_data {
 	u_int			 wp;
 };
 
+struct window_collect_history_pane {
+	struct window_pane	*wp;
+	int			 viewed;
+};
+
+/* Total history when the last collection could not get under the target. */
+static unsigned long long window_collect_history_failed;
+
 static struct window_pane *window_pane_create(struct window *, u_int, u_int,
 		    u_int);
 static void	window_pane_destroy(struct window_pane *);
@@ -198,6 +209,8 @@ winlink_set_window(struct winlink *wl, struct window *w)
 	TAILQ_INSERT_TAIL(&w->winlinks, wl, wentry);
 	wl->window = w;
 	window_add_ref(w, __func__);
+	if (wl->session != NULL)
+		wl->session->name_index_valid = 0;
 }
 
 void
@@ -210,6 +223,9 @@ winlink_remove(struct winlinks *wwl, struct winlink *wl)
 		window_remove_ref(w, __func__);
 	}
 
+	if (wl->session != NULL)
+		wl->session->name_index_valid = 0;
+
 	RB_REMOVE(winlinks, wwl, wl);
 	free(wl);
 }
@@ -361,6 +377,7 @@ window_destroy(struct window *w)
 
 	options_free(w->options);
 
+	free(w->border_map);
 	free(w->name);
 	free(w);
 }
@@ -371,7 +388,7 @@ window_pane_destroy_ready(struct window_pane *wp)
 	int	n;
 
 	if (wp->pipe_fd != -1) {
-		if (EVBUFFER_LENGTH(wp->pipe_event->output) != 0)
+		if (window_pane_pipe_backlog(wp) != 0)
 			return (0);
 		if (ioctl(wp->fd, FIONREAD, &n) != -1 && n > 0)
 			return (0);
@@ -402,8 +419,12 @@ window_remove_ref(struct window *w, const char *from)
 void
 window_set_name(struct window *w, const char *new_name)
 {
+	struct winlink	*wl;
+
 	free(w->name);
 	utf8_stravis(&w->name, new_name, VIS_OCTAL|VIS_CSTYLE|VIS_TAB|VIS_NL);
+	TAILQ_FOREACH(wl, &w->winlinks, wentry)
+		wl->session->name_index_valid = 0;
 	notify_window("window-renamed", w);
 }
 
@@ -664,6 +685,7 @@ void
 window_remove_pane(struct window *w, struct window_pane *wp)
 {
 	window_lost_pane(w, wp);
+	screen_redraw_invalidate(w);
 
 	TAILQ_REMOVE(&w->panes, wp, entry);
 	window_pane_destroy(wp);
@@ -833,6 +855,7 @@ window_pane_create(struct window *w, u_int sx, u_int sy, u_int hlimit)
 	wp->pipe_fd = -1;
 	wp->pipe_off = 0;
 	wp->pipe_event = NULL;
+	wp->pipe_spill_fd = -1;
 
 	wp->saved_grid = NULL;
 	wp->saved_cx = UINT_MAX;
@@ -857,6 +880,9 @@ window_pane_destroy(struct window_pane *wp)
 	window_pane_reset_mode_all(wp);
 	free(wp->searchstr);
 
+	window_pane_pipe_close(wp);
+	pane_log_close(wp);
+
 	if (wp->fd != -1) {
 #ifdef HAVE_UTEMPTER
 		utempter_remove_record(wp->fd);
@@ -873,11 +899,6 @@ window_pane_destroy(struct window_pane *wp)
 	if (wp->saved_grid != NULL)
 		grid_destroy(wp->saved_grid);
 
-	if (wp->pipe_fd != -1) {
-		bufferevent_free(wp->pipe_event);
-		close(wp->pipe_fd);
-	}
-
 	if (event_initialized(&wp->resize_timer))
 		event_del(&wp->resize_timer);
 
@@ -901,17 +922,294 @@ window_pane_read_callback(__unused struct bufferevent *bufev, void *data)
 	size_t			 new_size;
 
 	new_size = size - wp->pipe_off;
-	if (wp->pipe_fd != -1 && new_size > 0) {
-		new_data = EVBUFFER_DATA(evb) + wp->pipe_off;
-		bufferevent_write(wp->pipe_event, new_data, new_size);
-	}
+	new_data = EVBUFFER_DATA(evb) + wp->pipe_off;
+	if (wp->pipe_fd != -1 && new_size > 0)
+		window_pane_pipe_write(wp, new_data, new_size);
+	if (wp->log != NULL && new_size > 0)
+		pane_log_write(wp, new_data, new_size);
 
 	log_debug("%%%u has %zu bytes", wp->id, size);
 	input_parse(wp);
+	window_collect_history();
 
 	wp->pipe_off = EVBUFFER_LENGTH(evb);
 }
 
+/*
+ * Compare panes for collecting history: panes being viewed by a client last,
+ * then windows with older activity first, then panes that have been active
+ * least recently first.
+ */
+static int
+window_collect_history_cmp(const void *a, const void *b)
+{
+	const struct window_collect_history_pane	*hpa = a, *hpb = b;
+	struct window_pane				*wpa = hpa->wp;
+	struct window_pane				*wpb = hpb->wp;
+	struct window					*wa = wpa->window;
+	struct window					*wb = wpb->window;
+
+	if (hpa->viewed != hpb->viewed)
+		return (hpa->viewed - hpb->viewed);
+	if (timercmp(&wa->activity_time, &wb->activity_time, <))
+		return (-1);
+	if (timercmp(&wa->activity_time, &wb->activity_time, >))
+		return (1);
+	if (wpa->active_point < wpb->active_point)
+		return (-1);
+	if (wpa->active_point > wpb->active_point)
+		return (1);
+	return (0);
+}
+
+/*
+ * If the history of all panes is using more memory than history-memory-limit,
+ * free the oldest lines from the least recently used panes until it is 10%
+ * under the limit. Panes in a mode or with a capture-pane in progress are
+ * skipped, since their history may be being looked at. If that is not enough,
+ * do not try again until the total has grown or
+ * window_collect_history_reset is called.
+ */
+void
+window_collect_history(void)
+{
+	struct window_collect_history_pane	*list = NULL;
+	struct window_pane			*wp;
+	struct client				*c;
+	unsigned long long			 limit, target, total, freed;
+	u_int					 i, n = 0;
+
+	limit = options_get_number(global_options, "history-memory-limit");
+	if (limit == 0)
+		return;
+	limit *= 1024 * 1024;
+	total = grid_history_total_bytes();
+	if (total <= limit) {
+		window_collect_history_failed = 0;
+		return;
+	}
+	if (window_collect_history_failed != 0 &&
+	    total <= window_collect_history_failed)
+		return;
+	target = limit - limit / 10;
+
+	RB_FOREACH(wp, window_pane_tree, &all_window_panes) {
+		if (wp->base.grid->hsize == 0 ||
+		    !TAILQ_EMPTY(&wp->modes) ||
+		    wp->capturing != 0)
+			continue;
+		list = xreallocarray(list, n + 1, sizeof *list);
+		list[n].wp = wp;
+		list[n].viewed = 0;
+		TAILQ_FOREACH(c, &clients, entry) {
+			if (c->session == NULL ||
+			    (c->flags & CLIENT_NOSIZEFLAGS) ||
+			    c->session->curw->window != wp->window)
+				continue;
+			if (window_pane_visible(wp))
+				list[n].viewed = 1;
+			break;
+		}
+		n++;
+	}
+	qsort(list, n, sizeof *list, window_collect_history_cmp);
+
+	for (i = 0; i < n; i++) {
+		total = grid_history_total_bytes();
+		if (total <= target)
+			break;
+		wp = list[i].wp;
+		freed = grid_trim_history_bytes(wp->base.grid, total - target);
+		log_debug("%s: %%%u freed %llu bytes", __func__, wp->id, freed);
+	}
+	free(list);
+
+	total = grid_history_total_bytes();
+	if (total > target) {
+		log_debug("%s: %llu bytes left", __func__, total);
+		window_collect_history_failed = total;
+	} else
+		window_collect_history_failed = 0;
+}
+
+/*
+ * Let the next collection run even if the history has not grown, because a
+ * pane that was skipped may now be collected or the limit has changed.
+ */
+void
+window_collect_history_reset(void)
+{
+	window_collect_history_failed = 0;
+}
+
+/* Stop reading from a pane until its pipe has been emptied. */
+static void
+window_pane_pipe_block(struct window_pane *wp)
+{
+	if (wp->pipe_blocked)
+		return;
+	wp->pipe_blocked = 1;
+	log_debug("%%%u pipe blocked", wp->id);
+
+	if (wp->disabled++ == 0 && wp->fd != -1)
+		bufferevent_disable(wp->event, EV_READ|EV_WRITE);
+}
+
+/* Start reading from a pane again. */
+static void
+window_pane_pipe_unblock(struct window_pane *wp)
+{
+	if (!wp->pipe_blocked)
+		return;
+	wp->pipe_blocked = 0;
+	log_debug("%%%u pipe unblocked", wp->id);
+
+	if (--wp->disabled == 0 && wp->fd != -1)
+		bufferevent_enable(wp->event, EV_READ|EV_WRITE);
+}
+
+/* Discard any data in the spill file. */
+static void
+window_pane_pipe_reset_spill(struct window_pane *wp)
+{
+	if (wp->pipe_spill_fd != -1 && ftruncate(wp->pipe_spill_fd, 0) != 0) {
+		close(wp->pipe_spill_fd);
+		wp->pipe_spill_fd = -1;
+	}
+	wp->pipe_spill_off = wp->pipe_spill_size = 0;
+}
+
+/* Append data to the spill file, creating it if needed. */
+static int
+window_pane_pipe_spill(struct window_pane *wp, const void *data, size_t size)
+{
+	char	path[] = _PATH_TMP "tmux-pipe.XXXXXXXX";
+	ssize_t	n;
+
+	if (wp->pipe_spill_fd == -1) {
+		if ((wp->pipe_spill_fd = mkstemp(path)) == -1)
+			return (-1);
+		unlink(path);
+		log_debug("%%%u pipe spill file %s", wp->id, path);
+	}
+
+	n = pwrite(wp->pipe_spill_fd, data, size, wp->pipe_spill_size);
+	if (n == -1 || (size_t)n != size)
+		return (-1);
+	wp->pipe_spill_size += size;
+	return (0);
+}
+
+/* Close the pipe for a pane. */
+void
+window_pane_pipe_close(struct window_pane *wp)
+{
+	if (wp->pipe_fd == -1)
+		return;
+
+	bufferevent_free(wp->pipe_event);
+	close(wp->pipe_fd);
+	wp->pipe_fd = -1;
+
+	if (wp->pipe_spill_fd != -1) {
+		close(wp->pipe_spill_fd);
+		wp->pipe_spill_fd = -1;
+	}
+	wp->pipe_spill_off = wp->pipe_spill_size = 0;
+
+	window_pane_pipe_unblock(wp);
+}
+
+/*
+ * Queue pane output for the pipe. If the pipe already holds pipe-pane-limit
+ * or more, either block the pane, drop the output or spill it to a file,
+ * depending on pipe-pane-policy.
+ */
+void
+window_pane_pipe_write(struct window_pane *wp, const void *data, size_t size)
+{
+	size_t	queued = EVBUFFER_LENGTH(wp->pipe_event->output);
+	size_t	limit;
+	int	policy;
+
+	/* Nothing is written to a pipe opened with only -I. */
+	if (~wp->pipe_event->enabled & EV_WRITE)
+		return;
+
+	limit = options_get_number(wp->options, "pipe-pane-limit");
+	if (wp->pipe_spill_size != 0)
+		policy = PIPE_PANE_SPILL;
+	else {
+		if (limit == 0 || queued < limit) {
+			bufferevent_write(wp->pipe_event, data, size);
+			return;
+		}
+		policy = options_get_number(wp->options, "pipe-pane-policy");
+	}
+
+	switch (policy) {
+	case PIPE_PANE_BLOCK:
+		bufferevent_write(wp->pipe_event, data, size);
+		window_pane_pipe_block(wp);
+		break;
+	case PIPE_PANE_DROP:
+		wp->pipe_dropped += size;
+		break;
+	case PIPE_PANE_SPILL:
+		if (window_pane_pipe_spill(wp, data, size) != 0)
+			wp->pipe_dropped += size;
+		else if (queued == 0)
+			window_pane_pipe_written(wp);
+		break;
+	}
+}
+
+/*
+ * The pipe has been emptied, so refill it from the spill file or let the pane
+ * continue.
+ */
+void
+window_pane_pipe_written(struct window_pane *wp)
+{
+	size_t	 size;
+	ssize_t	 n;
+	char	*buf;
+
+	if (wp->pipe_spill_size != 0) {
+		size = wp->pipe_spill_size - wp->pipe_spill_off;
+		if (size > WINDOW_PANE_PIPE_READ)
+			size = WINDOW_PANE_PIPE_READ;
+		buf = xmalloc(size);
+
+		n = pread(wp->pipe_spill_fd, buf, size, wp->pipe_spill_off);
+		if (n <= 0) {
+			wp->pipe_dropped += wp->pipe_spill_size -
+			    wp->pipe_spill_off;
+			window_pane_pipe_reset_spill(wp);
+		} else {
+			bufferevent_write(wp->pipe_event, buf, n);
+			wp->pipe_spill_off += n;
+			if (wp->pipe_spill_off == wp->pipe_spill_size)
+				window_pane_pipe_reset_spill(wp);
+		}
+
+		free(buf);
+		if (wp->pipe_spill_size != 0)
+			return;
+	}
+	window_pane_pipe_unblock(wp);
+}
+
+/* Get the amount of pane output waiting to be written to the pipe. */
+size_t
+window_pane_pipe_backlog(struct window_pane *wp)
+{
+	if (wp->pipe_fd == -1)
+		return (0);
+	return (EVBUFFER_LENGTH(wp->pipe_event->output) +
+	    (wp->pipe_spill_size - wp->pipe_spill_off));
+}
+
 static void
 window_pane_error_callback(__unused struct bufferevent *bufev,
     __unused short what, void *data)
@@ -942,6 +1240,9 @@ window_pane_resize(struct window_pane *wp, u_int sx, u_int sy)
 {
 	struct window_mode_entry	*wme;
 
+	/* Callers may have moved the pane too, so always redo the borders. */
+	screen_redraw_invalidate(wp->window);
+
 	if (sx == wp->sx && sy == wp->sy)
 		return;
 	wp->sx = sx;
@@ -1175,6 +1476,7 @@ window_pane_reset_mode(struct window_pane *wp)
 		log_debug("%s: no next mode", __func__);
 		evtimer_del(&wp->modetimer);
 		wp->screen = &wp->base;
+		window_collect_history_reset();
 	} else {
 		log_debug("%s: next mode is %s", __func__, next->mode->name);
 		wp->screen = next->screen;
@@ -34,16 +34,14 @@
  * 7 Alt + Ctrl
  * 8 Shift + Alt + Ctrl
  *
- * Rather than parsing them, just match against a table.
+ * Rather than parsing them, the table is expanded for each modifier and
+ * compiled into the tty key table with the terminfo(5) keys.
  *
  * There are three forms for F1-F4 (\\033O_P and \\033O1;_P and \\033[1;_P).
  * We accept any but always output the latter (it comes first in the table).
  */
 
-static int	xterm_keys_match(const char *, const char *, size_t, size_t *,
-		    key_code *);
-static int	xterm_keys_modifiers(const char *, size_t, size_t *,
-		    key_code *);
+static key_code	xterm_keys_modifiers(u_int);
 
 struct xterm_keys_entry {
 	key_code	 key;
@@ -111,96 +109,48 @@ static const struct xterm_keys_entry xterm_keys_table[] = {
 	{ '\t',		"\033[27;_;9~" },
 };
 
-/*
- * Match key against buffer, treating _ as a wildcard. Return -1 for no match,
- * 0 for match, 1 if the end of the buffer is reached (need more data).
- */
-static int
-xterm_keys_match(const char *template, const char *buf, size_t len,
-    size_t *size, key_code *modifiers)
+/* Convert a modifier parameter into key modifiers. */
+static key_code
+xterm_keys_modifiers(u_int param)
 {
-	size_t	pos;
-	int	retval;
-
-	*modifiers = 0;
-
-	if (len == 0)
-		return (0);
-
-	pos = 0;
-	do {
-		if (*template == '_') {
-			retval = xterm_keys_modifiers(buf, len, &pos,
-			    modifiers);
-			if (retval != 0)
-				return (retval);
-			continue;
-		}
-		if (buf[pos] != *template)
-			return (-1);
-		pos++;
-	} while (*++template != '\0' && pos != len);
-
-	if (*template != '\0')	/* partial */
-		return (1);
-
-	*size = pos;
-	return (0);
-}
-
-/* Find modifiers from buffer. */
-static int
-xterm_keys_modifiers(const char *buf, size_t len, size_t *pos,
-    key_code *modifiers)
-{
-	u_int	flags;
-
-	if (len - *pos < 2)
-		return (1);
+	u_int		flags = param - 1;
+	key_code	modifiers = 0;
 
-	if (buf[*pos] < '0' || buf[*pos] > '9')
-		return (-1);
-	flags = buf[(*pos)++] - '0';
-	if (buf[*pos] >= '0' && buf[*pos] <= '9')
-		flags = (flags * 10) + (buf[(*pos)++] - '0');
-	flags -= 1;
-
-	*modifiers = 0;
 	if (flags & 1)
-		*modifiers |= KEYC_SHIFT;
+		modifiers |= KEYC_SHIFT;
 	if (flags & 2)
-		*modifiers |= KEYC_ESCAPE;
+		modifiers |= KEYC_ESCAPE;
 	if (flags & 4)
-		*modifiers |= KEYC_CTRL;
+		modifiers |= KEYC_CTRL;
 	if (flags & 8)
-		*modifiers |= KEYC_ESCAPE;
-	return (0);
+		modifiers |= KEYC_ESCAPE;
+	return (modifiers);
 }
 
 /*
- * Lookup key from a buffer against the table. Returns 0 for found (and the
- * key), -1 for not found, 1 for partial match.
+ * Expand every template in the table with each modifier parameter from 1 to
+ * 16 and pass the resulting sequences and keys to the callback. Earlier
+ * entries take precedence, so they are passed last.
  */
-int
-xterm_keys_find(const char *buf, size_t len, size_t *size, key_code *key)
+void
+xterm_keys_expand(void (*cb)(const char *, key_code, void *), void *data)
 {
 	const struct xterm_keys_entry	*entry;
-	u_int				 i;
-	int				 matched;
-	key_code			 modifiers;
-
-	for (i = 0; i < nitems(xterm_keys_table); i++) {
-		entry = &xterm_keys_table[i];
-
-		matched = xterm_keys_match(entry->template, buf, len, size,
-		    &modifiers);
-		if (matched == -1)
-			continue;
-		if (matched == 0)
-			*key = (entry->key|modifiers|KEYC_XTERM);
-		return (matched);
+	u_int				 i, param;
+	char				 s[32];
+	size_t				 n;
+
+	for (i = nitems(xterm_keys_table); i > 0; i--) {
+		entry = &xterm_keys_table[i - 1];
+
+		n = strcspn(entry->template, "_");
+		for (param = 1; param <= 16; param++) {
+			xsnprintf(s, sizeof s, "%.*s%u%s", (int)n,
+			    entry->template, param, entry->template + n + 1);
+			cb(s, entry->key|xterm_keys_modifiers(param)|KEYC_XTERM,
+			    data);
+		}
 	}
-	return (-1);
 }
 
 /* Lookup a key number from the table. */